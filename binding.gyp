@@ -4,8 +4,28 @@
       "target_name": "poppler_binding",
       "sources": [
         "src/cpp/poppler_binding.cpp",
+        "src/cpp/addon_data.cpp",
         "src/cpp/document.cpp",
-        "src/cpp/page.cpp"
+        "src/cpp/page.cpp",
+        "src/cpp/render.cpp",
+        "src/cpp/encode.cpp",
+        "src/cpp/layout.cpp",
+        "src/cpp/page_json.cpp",
+        "src/cpp/page_cache.cpp",
+        "src/cpp/mapped_file.cpp",
+        "src/cpp/async_task.cpp",
+        "src/cpp/worker_pool.cpp",
+        "src/cpp/page_stream.cpp",
+        "src/cpp/render_stream.cpp",
+        "src/cpp/result_stream.cpp",
+        "src/cpp/batch.cpp",
+        "src/cpp/cancel.cpp",
+        "src/cpp/stats.cpp",
+        "src/cpp/tile_cache.cpp",
+        "src/cpp/text_index.cpp",
+        "src/cpp/search_index.cpp",
+        "src/cpp/content_hash.cpp",
+        "src/cpp/extraction_cache.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -16,7 +36,9 @@
         "<!(node -p \"require('node-addon-api').gyp\")"
       ],
       "libraries": [
-        "-lpoppler-cpp"
+        "-lpoppler-cpp",
+        "-lpng",
+        "-ljpeg"
       ],
       "cflags!": ["-fno-exceptions"],
       "cflags_cc!": ["-fno-exceptions"],
@@ -27,7 +49,9 @@
         ["OS=='mac'", {
           "include_dirs": [
             "/opt/homebrew/include/poppler/cpp",
-            "/usr/local/include/poppler/cpp"
+            "/usr/local/include/poppler/cpp",
+            "/opt/homebrew/include",
+            "/usr/local/include"
           ],
           "libraries": [
             "-L/opt/homebrew/lib",
@@ -36,11 +60,14 @@
         }],
         ["OS=='win'", {
           "include_dirs": [
-            "C:/vcpkg/installed/x64-windows/include/poppler/cpp"
+            "C:/vcpkg/installed/x64-windows/include/poppler/cpp",
+            "C:/vcpkg/installed/x64-windows/include"
           ],
           "libraries": [
             "-LC:/vcpkg/installed/x64-windows/lib",
-            "poppler-cpp.lib"
+            "poppler-cpp.lib",
+            "libpng16.lib",
+            "jpeg.lib"
           ]
         }]
       ]
@@ -0,0 +1,34 @@
+// src/bench/layout.ts - line grouping cost on pathological (dense table) pages
+import { Document } from '../index';
+import { buildPdf, tablePage } from './synthetic';
+
+const RUNS = 5;
+
+function median(values: number[]): number {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+function benchmarkLayout() {
+  // Grid sizes double the word count each step; near-linear scaling shows
+  // up as a roughly constant time per box
+  const grids: Array<[number, number]> = [[25, 10], [50, 10], [50, 20], [100, 20], [100, 40], [200, 40], [200, 80]];
+
+  for (const [rows, cols] of grids) {
+    const doc = Document.loadFromBuffer(buildPdf([tablePage(rows, cols)]));
+    const page = doc.getPage(0);
+    const boxes = page.getTextBoxes().length;
+
+    const times: number[] = [];
+    for (let i = 0; i < RUNS; i++) {
+      const start = process.hrtime.bigint();
+      page.exportToJSON();
+      times.push(Number(process.hrtime.bigint() - start) / 1e6);
+    }
+
+    const ms = median(times);
+    console.log(JSON.stringify({ bench: 'exportToJSON', rows, cols, boxes, ms, usPerBox: (ms * 1000) / boxes }));
+  }
+}
+
+benchmarkLayout();
@@ -0,0 +1,145 @@
+// src/bench/suite.ts - hot path benchmarks over synthetic corpora
+//
+// Prints one JSON object per line. Run with --expose-gc (npm run bench) so
+// allocation figures start from a collected heap. Pass corpus names to run
+// a subset, e.g. `npm run bench -- dense tables`.
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { Document } from '../index';
+import type { Document as PdfDocument, Page as PdfPage } from '../types';
+import { buildPdf, densePage, imagePage, tablePage } from './synthetic';
+
+interface Corpus {
+  name: string;
+  build: () => Buffer;
+  renderPages: number; // pages rendered per DPI; rendering every page would dominate the run
+}
+
+interface Sample {
+  corpus: string;
+  op: string;
+  pages: number;
+  opsPerSec: number;
+  p50Ms: number;
+  p99Ms: number;
+  peakRssMb: number;
+  allocatedBytesPerPage: number;
+}
+
+const CORPORA: Corpus[] = [
+  { name: 'dense', build: () => buildPdf(Array.from({ length: 20 }, (_, i) => densePage(i + 1))), renderPages: 5 },
+  { name: 'many-pages', build: () => buildPdf(Array.from({ length: 1000 }, (_, i) => densePage(i + 1, 12))), renderPages: 5 },
+  { name: 'images', build: () => buildPdf(Array.from({ length: 4 }, () => imagePage(1500, 1500))), renderPages: 4 },
+  { name: 'tables', build: () => buildPdf(Array.from({ length: 10 }, () => tablePage(100, 20))), renderPages: 5 }
+];
+
+const DPIS = [72, 150, 300];
+const MIN_SAMPLES = 5;
+const MIN_TIME_MS = 500;
+
+const collect: () => void = (global as { gc?: () => void }).gc ?? (() => undefined);
+
+function percentile(sorted: number[], p: number): number {
+  return sorted[Math.min(sorted.length - 1, Math.floor((sorted.length * p) / 100))];
+}
+
+function heapBytes(): number {
+  const usage = process.memoryUsage();
+  return usage.heapUsed + usage.external;
+}
+
+function peakRssMb(): number {
+  // maxRSS is reported in kilobytes
+  return process.resourceUsage().maxRSS / 1024;
+}
+
+/**
+ * Times `fn` until both MIN_SAMPLES and MIN_TIME_MS are reached, then makes
+ * one more pass with its results kept alive to measure what it allocates.
+ */
+function measure(corpus: string, op: string, pages: number, fn: () => unknown): Sample {
+  const times: number[] = [];
+  const deadline = Date.now() + MIN_TIME_MS;
+  while (times.length < MIN_SAMPLES || Date.now() < deadline) {
+    const start = process.hrtime.bigint();
+    fn();
+    times.push(Number(process.hrtime.bigint() - start) / 1e6);
+  }
+  times.sort((a, b) => a - b);
+
+  collect();
+  const before = heapBytes();
+  const retained = fn();
+  const allocated = heapBytes() - before;
+  void retained;
+
+  const totalMs = times.reduce((sum, t) => sum + t, 0);
+  return {
+    corpus,
+    op,
+    pages,
+    opsPerSec: (times.length * 1000) / totalMs,
+    p50Ms: percentile(times, 50),
+    p99Ms: percentile(times, 99),
+    peakRssMb: peakRssMb(),
+    allocatedBytesPerPage: Math.max(0, allocated) / pages
+  };
+}
+
+function eachPage<T>(doc: PdfDocument, count: number, fn: (page: PdfPage) => T): T[] {
+  const results: T[] = [];
+  for (let i = 0; i < count; i++) {
+    results.push(fn(doc.getPage(i)));
+  }
+  return results;
+}
+
+function benchmarkCorpus(corpus: Corpus, dir: string): void {
+  const buffer = corpus.build();
+  const file = path.join(dir, `${corpus.name}.pdf`);
+  fs.writeFileSync(file, buffer);
+
+  const samples: Sample[] = [];
+  const probe = Document.loadFromBuffer(buffer);
+  const pageCount = probe.getPageCount();
+
+  samples.push(measure(corpus.name, 'loadFromFile', pageCount, () => Document.loadFromFile(file)));
+  samples.push(measure(corpus.name, 'loadFromBuffer', pageCount, () => Document.loadFromBuffer(buffer)));
+
+  // Parse every page up front so the text benchmarks measure extraction,
+  // not the first getPage() of each page
+  const doc: PdfDocument = Document.loadFromBuffer(buffer);
+  doc.setPageCacheSize(pageCount);
+  eachPage(doc, pageCount, () => undefined);
+
+  samples.push(measure(corpus.name, 'getText', pageCount, () => eachPage(doc, pageCount, (page) => page.getText())));
+  samples.push(measure(corpus.name, 'getTextBoxes', pageCount, () => eachPage(doc, pageCount, (page) => page.getTextBoxes())));
+  samples.push(measure(corpus.name, 'exportToJSON', pageCount, () => eachPage(doc, pageCount, (page) => page.exportToJSON())));
+
+  const renderPages = Math.min(corpus.renderPages, pageCount);
+  for (const dpi of DPIS) {
+    samples.push(measure(corpus.name, `renderToImage@${dpi}`, renderPages,
+      () => eachPage(doc, renderPages, (page) => page.renderToImage({ dpi }))));
+  }
+
+  for (const sample of samples) {
+    console.log(JSON.stringify(sample));
+  }
+}
+
+function runSuite(): void {
+  const selected = process.argv.slice(2);
+  const corpora = selected.length > 0 ? CORPORA.filter((c) => selected.includes(c.name)) : CORPORA;
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'poppler-bench-'));
+
+  try {
+    for (const corpus of corpora) {
+      benchmarkCorpus(corpus, dir);
+    }
+  } finally {
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+}
+
+runSuite();
@@ -0,0 +1,123 @@
+// src/bench/synthetic.ts - in-memory PDF generator for benchmarks
+
+export interface SyntheticWord {
+  x: number;
+  y: number; // PDF user space: origin at the bottom-left corner
+  size: number;
+  text: string;
+}
+
+const PAGE_WIDTH = 612;
+const PAGE_HEIGHT = 792;
+
+function escapeText(text: string): string {
+  return text.replace(/[\\()]/g, (c) => `\\${c}`);
+}
+
+/**
+ * Content stream drawing each word with the built-in Helvetica font
+ */
+export function textContent(words: SyntheticWord[]): string {
+  const ops: string[] = ['BT'];
+  for (const word of words) {
+    ops.push(`/F1 ${word.size} Tf 1 0 0 1 ${word.x.toFixed(2)} ${word.y.toFixed(2)} Tm (${escapeText(word.text)}) Tj`);
+  }
+  ops.push('ET');
+  return ops.join('\n');
+}
+
+/**
+ * Builds a complete PDF with one page per content stream
+ */
+export function buildPdf(contents: string[]): Buffer {
+  const objects: string[] = [];
+  const pageIds: number[] = [];
+
+  // 1: catalog, 2: page tree, 3: font, then a page and its content per page
+  objects.push('<< /Type /Catalog /Pages 2 0 R >>');
+  objects.push(''); // page tree, filled in once the page ids are known
+  objects.push('<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>');
+
+  for (const content of contents) {
+    const pageId = objects.length + 1;
+    pageIds.push(pageId);
+    objects.push(`<< /Type /Page /Parent 2 0 R /MediaBox [0 0 ${PAGE_WIDTH} ${PAGE_HEIGHT}] ` +
+      `/Resources << /Font << /F1 3 0 R >> >> /Contents ${pageId + 1} 0 R >>`);
+    objects.push(`<< /Length ${Buffer.byteLength(content, 'latin1')} >>\nstream\n${content}\nendstream`);
+  }
+  objects[1] = `<< /Type /Pages /Kids [${pageIds.map((id) => `${id} 0 R`).join(' ')}] /Count ${pageIds.length} >>`;
+
+  let pdf = '%PDF-1.4\n';
+  const offsets: number[] = [];
+  objects.forEach((body, i) => {
+    offsets.push(Buffer.byteLength(pdf, 'latin1'));
+    pdf += `${i + 1} 0 obj\n${body}\nendobj\n`;
+  });
+
+  const xrefOffset = Buffer.byteLength(pdf, 'latin1');
+  pdf += `xref\n0 ${objects.length + 1}\n0000000000 65535 f \n`;
+  for (const offset of offsets) {
+    pdf += `${offset.toString().padStart(10, '0')} 00000 n \n`;
+  }
+  pdf += `trailer\n<< /Size ${objects.length + 1} /Root 1 0 R >>\nstartxref\n${xrefOffset}\n%%EOF\n`;
+
+  return Buffer.from(pdf, 'latin1');
+}
+
+/**
+ * A rows x cols grid of short cells, like a spreadsheet printed to PDF
+ */
+export function tablePage(rows: number, cols: number): string {
+  const words: SyntheticWord[] = [];
+  const cellWidth = (PAGE_WIDTH - 20) / cols;
+  const rowHeight = (PAGE_HEIGHT - 20) / rows;
+  const size = Math.max(1, Math.min(10, rowHeight * 0.8));
+  for (let r = 0; r < rows; r++) {
+    for (let c = 0; c < cols; c++) {
+      words.push({ x: 10 + c * cellWidth, y: PAGE_HEIGHT - 10 - (r + 1) * rowHeight, size, text: `${r}:${c}` });
+    }
+  }
+  return textContent(words);
+}
+
+const DICTIONARY = ['lorem', 'ipsum', 'dolor', 'sit', 'amet', 'consectetur', 'adipiscing', 'elit', 'sed', 'do',
+  'eiusmod', 'tempor', 'incididunt', 'ut', 'labore', 'et', 'dolore', 'magna', 'aliqua'];
+
+/**
+ * Paragraph text in a small font filling the whole page
+ */
+export function densePage(seed: number, size = 6): string {
+  const words: SyntheticWord[] = [];
+  const lineHeight = size * 1.2;
+  let state = seed >>> 0;
+  for (let y = PAGE_HEIGHT - 20; y > 20; y -= lineHeight) {
+    let x = 20;
+    while (x < PAGE_WIDTH - 60) {
+      // Fixed LCG so every run generates the same corpus
+      state = (Math.imul(state, 1664525) + 1013904223) >>> 0;
+      const text = DICTIONARY[state % DICTIONARY.length];
+      words.push({ x, y, size, text });
+      x += (text.length + 1) * size * 0.55;
+    }
+  }
+  return textContent(words);
+}
+
+/**
+ * A full-page RGB inline image, hex encoded so the content stays printable
+ */
+export function imagePage(width: number, height: number): string {
+  const rows: string[] = [];
+  for (let y = 0; y < height; y++) {
+    let row = '';
+    for (let x = 0; x < width; x++) {
+      const r = (x * 255 / width) | 0;
+      const g = (y * 255 / height) | 0;
+      const b = (x ^ y) & 0xff;
+      row += r.toString(16).padStart(2, '0') + g.toString(16).padStart(2, '0') + b.toString(16).padStart(2, '0');
+    }
+    rows.push(row);
+  }
+  return `q ${PAGE_WIDTH} 0 0 ${PAGE_HEIGHT} 0 0 cm\n` +
+    `BI /W ${width} /H ${height} /CS /RGB /BPC 8 /F /AHx ID\n${rows.join('\n')}>\nEI\nQ`;
+}
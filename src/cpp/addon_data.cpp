@@ -0,0 +1,140 @@
+// src/cpp/addon_data.cpp
+#include "addon_data.h"
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace {
+
+// JS references owned by native code that may be dropped on any thread
+struct JsPinned {
+  virtual ~JsPinned() = default;
+  // True if Release() calls into JS, which must wait for the event loop
+  virtual bool CallsJs() const { return false; }
+  // Runs on the JS thread just before the references are deleted
+  virtual void Release(Napi::Env) {}
+  // The env is gone and took its references with it
+  virtual void Abandon() = 0;
+};
+
+struct PinnedObject : JsPinned {
+  explicit PinnedObject(Napi::Object object) : ref(Napi::Persistent(object)) {}
+  void Abandon() override { ref.SuppressDestruct(); }
+  
+  Napi::ObjectReference ref;
+};
+
+struct PinnedListener : JsPinned {
+  PinnedListener(Napi::Object eventTarget, std::string eventType, Napi::Function callback)
+      : target(Napi::Persistent(eventTarget)), type(std::move(eventType)), listener(Napi::Persistent(callback)) {}
+  
+  bool CallsJs() const override { return true; }
+  
+  void Release(Napi::Env env) override {
+    Napi::HandleScope scope(env);
+    Napi::Value remove = target.Value().Get("removeEventListener");
+    if (remove.IsFunction()) {
+      remove.As<Napi::Function>().Call(target.Value(), { Napi::String::New(env, type), listener.Value() });
+    }
+    if (env.IsExceptionPending()) {
+      env.GetAndClearPendingException();
+    }
+  }
+  
+  void Abandon() override {
+    target.SuppressDestruct();
+    listener.SuppressDestruct();
+  }
+  
+  Napi::ObjectReference target;
+  std::string type;
+  Napi::FunctionReference listener;
+};
+
+} // namespace
+
+struct JsReleaser {
+  std::mutex mutex;
+  // Unref'd, so pending releases never keep the process alive
+  Napi::ThreadSafeFunction tsfn;
+  bool closed = false;
+  std::thread::id jsThread;
+
+  void Release(JsPinned* pinned) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) {
+      pinned->Abandon();
+      delete pinned;
+      return;
+    }
+    if (std::this_thread::get_id() == jsThread && !pinned->CallsJs()) {
+      delete pinned;
+      return;
+    }
+
+    // Calls into JS are deferred even on the JS thread: the owner may be
+    // dropped inside a finalizer, where JS must not run
+    napi_status status = tsfn.NonBlockingCall(pinned, [](Napi::Env env, Napi::Function, JsPinned* data) {
+      if (env == nullptr) {
+        // Queued calls are dropped without an env while it shuts down
+        data->Abandon();
+      } else {
+        data->Release(env);
+      }
+      delete data;
+    });
+    if (status != napi_ok) {
+      pinned->Abandon();
+      delete pinned;
+    }
+  }
+};
+
+AddonData* AddonData::Init(Napi::Env env) {
+  AddonData* data = new AddonData();
+
+  auto releaser = std::make_shared<JsReleaser>();
+  releaser->jsThread = std::this_thread::get_id();
+  releaser->tsfn = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+      "poppler:release", 0, 1,
+      [releaser](Napi::Env) {
+        std::lock_guard<std::mutex> lock(releaser->mutex);
+        releaser->closed = true;
+      });
+  releaser->tsfn.Unref(env);
+  data->releaser = releaser;
+
+  // Deleted by node-addon-api when the env is torn down
+  env.SetInstanceData(data);
+  return data;
+}
+
+AddonData* AddonData::Get(Napi::Env env) {
+  return env.GetInstanceData<AddonData>();
+}
+
+std::shared_ptr<const void> PinJsObject(Napi::Env env, Napi::Object object) {
+  std::shared_ptr<JsReleaser> releaser = AddonData::Get(env)->releaser;
+  return std::shared_ptr<const void>(new PinnedObject(object), [releaser](const void* pinned) {
+    releaser->Release(static_cast<JsPinned*>(const_cast<void*>(pinned)));
+  });
+}
+
+std::shared_ptr<const void> PinEventListener(Napi::Env env, Napi::Object target, const std::string& type,
+                                             Napi::Function listener) {
+  std::shared_ptr<JsReleaser> releaser = AddonData::Get(env)->releaser;
+  return std::shared_ptr<const void>(new PinnedListener(target, type, listener), [releaser](const void* pinned) {
+    releaser->Release(static_cast<JsPinned*>(const_cast<void*>(pinned)));
+  });
+}
+
+void DefineDisposeSymbol(Napi::Env env, Napi::Function constructor) {
+  Napi::Value dispose = env.Global().Get("Symbol").As<Napi::Object>().Get("dispose");
+  if (!dispose.IsSymbol()) {
+    return;
+  }
+  
+  Napi::Object prototype = constructor.Get("prototype").As<Napi::Object>();
+  prototype.Set(dispose, prototype.Get("dispose"));
+}
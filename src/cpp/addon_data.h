@@ -0,0 +1,45 @@
+// src/cpp/addon_data.h
+#ifndef ADDON_DATA_H
+#define ADDON_DATA_H
+
+#include <napi.h>
+#include <memory>
+#include <string>
+
+struct JsReleaser;
+
+// Per-environment state of the addon. The main thread and every
+// worker_thread that loads the binding get their own copy, stored as the
+// env's instance data and freed when that env shuts down, so class
+// constructors and thread-safe functions never cross environments.
+struct AddonData {
+  Napi::FunctionReference documentConstructor;
+  Napi::FunctionReference pageConstructor;
+  Napi::FunctionReference resultStreamConstructor;
+  Napi::FunctionReference searchIndexConstructor;
+  // Returns pinned JS objects to this env from other threads
+  std::shared_ptr<JsReleaser> releaser;
+
+  // Creates the env's instance data; must run before any class is defined
+  static AddonData* Init(Napi::Env env);
+  static AddonData* Get(Napi::Env env);
+};
+
+// Keeps `object` (and any memory it owns, such as a SharedArrayBuffer's
+// backing store) alive for as long as the returned owner. The owner may be
+// dropped on any thread: the reference itself is released on the JS
+// thread. If the env has already shut down the reference is abandoned with
+// it.
+std::shared_ptr<const void> PinJsObject(Napi::Env env, Napi::Object object);
+
+// For a listener already added to `target` with addEventListener(type):
+// removes it again once the returned owner is dropped, from any thread.
+// The removal runs on the JS thread; if the env has shut down it is skipped.
+std::shared_ptr<const void> PinEventListener(Napi::Env env, Napi::Object target, const std::string& type,
+                                             Napi::Function listener);
+
+// Points Symbol.dispose at the class's dispose() method, so `using`
+// declarations release native memory; a no-op on runtimes without it
+void DefineDisposeSymbol(Napi::Env env, Napi::Function constructor);
+
+#endif // ADDON_DATA_H
@@ -0,0 +1,71 @@
+// src/cpp/async_task.cpp
+#include "async_task.h"
+#include "worker_pool.h"
+#include <exception>
+
+AsyncTask::AsyncTask(Napi::Env env)
+    : env_(env), deferred_(Napi::Promise::Deferred::New(env)) {}
+
+Napi::Value AsyncTask::Queue() {
+  Napi::Env env = env_;
+  Napi::Promise promise = deferred_.Promise();
+
+  // The thread-safe function is only used to hop back onto the JS thread;
+  // while it is alive it also keeps the event loop from exiting early.
+  tsfn_ = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+      "poppler:AsyncTask", 0, 1);
+
+  if (!WorkerPool::Shared().TrySubmit([this]() { Run(); })) {
+    tsfn_.Release();
+    deferred_.Reject(Napi::Error::New(env, "Worker queue is full").Value());
+    delete this;
+  }
+
+  return promise;
+}
+
+void AsyncTask::Pin(Napi::Object object) {
+  pins_.push_back(Napi::Persistent(object));
+}
+
+void AsyncTask::SetError(const std::string& message) {
+  failed_ = true;
+  error_ = message;
+}
+
+void AsyncTask::Run() {
+  try {
+    Execute();
+  } catch (const std::exception& e) {
+    SetError(e.what());
+  }
+
+  // Copy first: once queued, the JS thread may delete this task before the
+  // call returns.
+  Napi::ThreadSafeFunction tsfn = tsfn_;
+  // If the environment is already shutting down the call fails and the task
+  // is leaked on purpose, since its references can no longer be released.
+  tsfn.BlockingCall(this, [](Napi::Env env, Napi::Function, AsyncTask* task) {
+    task->Complete(env);
+    delete task;
+  });
+  tsfn.Release();
+}
+
+void AsyncTask::Complete(Napi::Env env) {
+  Napi::HandleScope scope(env);
+
+  if (failed_) {
+    deferred_.Reject(Napi::Error::New(env, error_).Value());
+    return;
+  }
+
+  Napi::Value result = OnOK(env);
+  if (env.IsExceptionPending()) {
+    deferred_.Reject(env.GetAndClearPendingException().Value());
+    return;
+  }
+
+  deferred_.Resolve(result);
+}
@@ -0,0 +1,48 @@
+// src/cpp/async_task.h
+#ifndef ASYNC_TASK_H
+#define ASYNC_TASK_H
+
+#include <napi.h>
+#include <string>
+#include <vector>
+
+// Promise-returning unit of work executed on the shared WorkerPool.
+// Execute() runs on a pool thread and must not touch any JS value; OnOK()
+// runs back on the JS thread and produces the value the promise resolves to.
+// A task deletes itself once its promise has settled.
+class AsyncTask {
+public:
+  explicit AsyncTask(Napi::Env env);
+  virtual ~AsyncTask() = default;
+
+  AsyncTask(const AsyncTask&) = delete;
+  AsyncTask& operator=(const AsyncTask&) = delete;
+
+  // Hands the task to the pool and returns its promise. Takes ownership of
+  // the task; if the pool queue is full the promise is rejected right away.
+  Napi::Value Queue();
+
+  // Keeps a JS object (and the native state it wraps) alive until the
+  // promise settles
+  void Pin(Napi::Object object);
+
+protected:
+  virtual void Execute() = 0;
+  virtual Napi::Value OnOK(Napi::Env env) = 0;
+
+  // Rejects the promise with `message` instead of calling OnOK()
+  void SetError(const std::string& message);
+
+private:
+  void Run();
+  void Complete(Napi::Env env);
+
+  Napi::Env env_;
+  Napi::Promise::Deferred deferred_;
+  Napi::ThreadSafeFunction tsfn_;
+  std::vector<Napi::ObjectReference> pins_;
+  std::string error_;
+  bool failed_ = false;
+};
+
+#endif // ASYNC_TASK_H
@@ -0,0 +1,360 @@
+// src/cpp/batch.cpp
+#include "batch.h"
+#include "cancel.h"
+#include "document_handle.h"
+#include "render.h"
+#include "result_stream.h"
+#include "stats.h"
+#include "worker_pool.h"
+#include <poppler/cpp/poppler-page.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BatchJob {
+  DocumentSource source;
+  bool text = false;
+  bool render = false;
+  RenderOptions renderOptions;
+  bool allPages = true;
+  std::vector<int> pages;
+  double timeoutMs = 0;  // 0: no limit
+  double maxBytes = 0;   // 0: no limit
+};
+
+class BatchResult : public StreamItem {
+public:
+  size_t index = 0;
+  int pageCount = 0;
+  std::vector<int> pages;
+  std::vector<std::string> texts;
+  std::vector<RenderOutput> images;
+  bool text = false;
+  bool render = false;
+  std::string error;
+  
+  Napi::Value ToValue(Napi::Env env) override {
+    Napi::Object value = Napi::Object::New(env);
+    value.Set("index", Napi::Number::New(env, static_cast<double>(index)));
+    
+    if (!error.empty()) {
+      value.Set("error", Napi::String::New(env, error));
+      return value;
+    }
+    
+    value.Set("pageCount", Napi::Number::New(env, pageCount));
+    
+    Napi::Array pageArray = Napi::Array::New(env, pages.size());
+    for (size_t i = 0; i < pages.size(); ++i) {
+      pageArray.Set(i, Napi::Number::New(env, pages[i]));
+    }
+    value.Set("pages", pageArray);
+    
+    if (text) {
+      Napi::Array textArray = Napi::Array::New(env, texts.size());
+      for (size_t i = 0; i < texts.size(); ++i) {
+        CountCopiedToJs(texts[i].size());
+        textArray.Set(i, Napi::String::New(env, texts[i]));
+      }
+      value.Set("text", textArray);
+    }
+    
+    if (render) {
+      Napi::Array imageArray = Napi::Array::New(env, images.size());
+      for (size_t i = 0; i < images.size(); ++i) {
+        imageArray.Set(i, RenderOutputToObject(env, images[i]));
+      }
+      value.Set("images", imageArray);
+    }
+    
+    return value;
+  }
+};
+
+// Reads a non-negative number option, leaving `target` alone when absent
+bool parseLimit(Napi::Env env, Napi::Object object, const char* name, double* target) {
+  if (!object.Has(name)) {
+    return true;
+  }
+  
+  Napi::Value value = object.Get(name);
+  if (!value.IsNumber() || value.As<Napi::Number>().DoubleValue() < 0) {
+    Napi::TypeError::New(env, std::string("Expected ") + name + " to be a non-negative number")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+  *target = value.As<Napi::Number>().DoubleValue();
+  return true;
+}
+
+bool parseJob(Napi::Env env, Napi::Value value, const BatchJob& defaults, BatchJob* job) {
+  if (!value.IsObject() || !value.As<Napi::Object>().Get("buffer").IsBuffer()) {
+    Napi::TypeError::New(env, "Expected each job to be { buffer, ops }").ThrowAsJavaScriptException();
+    return false;
+  }
+  
+  Napi::Object object = value.As<Napi::Object>();
+  *job = defaults;
+  
+  // Workers open the document long after this call returns, so the job
+  // keeps its own copy instead of borrowing the Buffer
+  Napi::Buffer<char> buffer = object.Get("buffer").As<Napi::Buffer<char>>();
+  auto bytes = std::make_shared<const std::vector<char>>(buffer.Data(), buffer.Data() + buffer.Length());
+  job->source.data = bytes->data();
+  job->source.length = bytes->size();
+  job->source.owner = bytes;
+  
+  if (!parseLimit(env, object, "timeoutMs", &job->timeoutMs) ||
+      !parseLimit(env, object, "maxBytes", &job->maxBytes)) {
+    return false;
+  }
+  
+  if (!object.Has("ops") || !object.Get("ops").IsObject()) {
+    // Loading alone still reports the page count
+    return true;
+  }
+  
+  Napi::Object ops = object.Get("ops").As<Napi::Object>();
+  
+  if (ops.Has("password") && ops.Get("password").IsString()) {
+    job->source.password = ops.Get("password").As<Napi::String>().Utf8Value();
+  }
+  
+  if (ops.Has("text")) {
+    job->text = ops.Get("text").ToBoolean().Value();
+  }
+  
+  if (ops.Has("render")) {
+    Napi::Value renderValue = ops.Get("render");
+    // true renders with the defaults; an object is a set of render options
+    job->render = renderValue.IsObject() || renderValue.ToBoolean().Value();
+    if (job->render && !ParseRenderOptions(renderValue, &job->renderOptions)) {
+      return false;
+    }
+  }
+  
+  if (ops.Has("pages") && !ops.Get("pages").IsUndefined()) {
+    Napi::Value pagesValue = ops.Get("pages");
+    if (!pagesValue.IsArray()) {
+      Napi::TypeError::New(env, "Expected pages to be an array of page indices").ThrowAsJavaScriptException();
+      return false;
+    }
+    
+    // Ranges are checked per job once its page count is known
+    Napi::Array pagesArray = pagesValue.As<Napi::Array>();
+    job->allPages = false;
+    job->pages.reserve(pagesArray.Length());
+    for (uint32_t i = 0; i < pagesArray.Length(); ++i) {
+      Napi::Value indexValue = pagesArray.Get(i);
+      if (!indexValue.IsNumber()) {
+        Napi::TypeError::New(env, "Expected page number").ThrowAsJavaScriptException();
+        return false;
+      }
+      job->pages.push_back(indexValue.As<Napi::Number>().Int32Value());
+    }
+  }
+  
+  return true;
+}
+
+// Tracks a job's deadline and the bytes it holds (input, text and images)
+class JobBudget {
+public:
+  explicit JobBudget(const BatchJob& job)
+      : job_(job), start_(Clock::now()), bytes_(static_cast<double>(job.source.length)) {}
+  
+  void CheckTime() const {
+    if (job_.timeoutMs <= 0) {
+      return;
+    }
+    double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+    if (elapsed > job_.timeoutMs) {
+      throw std::runtime_error("Timed out after " + std::to_string(static_cast<long long>(elapsed)) + " ms");
+    }
+  }
+  
+  // Throws before the job would exceed maxBytes by holding `bytes` more
+  void Reserve(double bytes) const {
+    if (job_.maxBytes > 0 && bytes_ + bytes > job_.maxBytes) {
+      throw std::runtime_error("Memory budget of " + std::to_string(static_cast<long long>(job_.maxBytes)) +
+                               " bytes exceeded");
+    }
+  }
+  
+  void Add(double bytes) {
+    Reserve(bytes);
+    bytes_ += bytes;
+  }
+
+private:
+  const BatchJob& job_;
+  Clock::time_point start_;
+  double bytes_;
+};
+
+// Runs one job start to finish on the calling worker. The deadline is
+// checked between pages, so a single slow page can overrun it.
+void runJob(const BatchJob& job, BatchResult& result, const StreamEmitter& emitter,
+            const std::shared_ptr<const CancelToken>& cancel) {
+  JobBudget budget(job);
+  budget.Reserve(0);
+  
+  std::unique_ptr<poppler::document> doc = job.source.Open();
+  if (!doc) {
+    throw std::runtime_error("Failed to load PDF document from buffer");
+  }
+  if (doc->is_locked()) {
+    throw std::runtime_error("Document is locked");
+  }
+  
+  result.pageCount = doc->pages();
+  if (job.allPages) {
+    result.pages.reserve(result.pageCount);
+    for (int i = 0; i < result.pageCount; ++i) {
+      result.pages.push_back(i);
+    }
+  } else {
+    result.pages = job.pages;
+    for (int index : result.pages) {
+      if (index < 0 || index >= result.pageCount) {
+        throw std::runtime_error("Page index out of range: " + std::to_string(index));
+      }
+    }
+  }
+  
+  // Same defaults as a loaded Document's renderer
+  poppler::page_renderer renderer;
+  renderer.set_render_hint(poppler::page_renderer::antialiasing, true);
+  renderer.set_render_hint(poppler::page_renderer::text_antialiasing, true);
+  
+  for (int index : result.pages) {
+    if (emitter.Cancelled()) {
+      return;
+    }
+    CheckCancelled(cancel);
+    budget.CheckTime();
+    
+    std::unique_ptr<poppler::page> page;
+    {
+      StatsTimer timer(Stats::Global().pageCreate, "pageCreate");
+      page.reset(doc->create_page(index));
+    }
+    if (!page) {
+      throw std::runtime_error("Failed to create page " + std::to_string(index));
+    }
+    
+    if (job.text) {
+      poppler::byte_array utf8_bytes;
+      {
+        StatsTimer timer(Stats::Global().textExtract, "textExtract");
+        utf8_bytes = page->text().to_utf8();
+      }
+      budget.Add(static_cast<double>(utf8_bytes.size()));
+      result.texts.emplace_back(utf8_bytes.data(), utf8_bytes.size());
+    }
+    
+    if (job.render) {
+      // Refuse before rendering: the bitmap is the job's largest allocation
+      budget.Reserve(RenderPixelCount(page.get(), job.renderOptions) * 4.0);
+      
+      RenderOutput output;
+      output.encoding = job.renderOptions.encoding;
+      output.image = RenderPage(renderer, page.get(), job.renderOptions);
+      if (!output.image.is_valid()) {
+        throw std::runtime_error("Failed to render page " + std::to_string(index));
+      }
+      EncodeRenderOutput(output);
+      budget.Add(static_cast<double>(RenderOutputByteLength(output)));
+      result.images.push_back(std::move(output));
+    }
+  }
+  
+  budget.CheckTime();
+}
+
+} // namespace
+
+Napi::Value ProcessBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of jobs").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  // Batch-wide limits; each job may override them
+  BatchJob defaults;
+  size_t concurrency = WorkerPool::Shared().Concurrency();
+  std::shared_ptr<CancelToken> cancel;
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+    
+    // timeoutMs is per job here, so only the signal applies to the batch
+    Napi::Object signalOnly = Napi::Object::New(env);
+    signalOnly.Set("signal", options.Get("signal"));
+    if (!ParseCancelToken(signalOnly, &cancel)) {
+      return env.Null();
+    }
+    if (!parseLimit(env, options, "timeoutMs", &defaults.timeoutMs) ||
+        !parseLimit(env, options, "maxBytes", &defaults.maxBytes)) {
+      return env.Null();
+    }
+    
+    if (options.Has("concurrency")) {
+      Napi::Value concurrencyValue = options.Get("concurrency");
+      if (!concurrencyValue.IsNumber() || concurrencyValue.As<Napi::Number>().Int32Value() < 1) {
+        Napi::TypeError::New(env, "Expected concurrency to be a positive number").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      concurrency = concurrencyValue.As<Napi::Number>().Uint32Value();
+    }
+  }
+  
+  Napi::Array jobsArray = info[0].As<Napi::Array>();
+  auto jobs = std::make_shared<std::vector<BatchJob>>(jobsArray.Length());
+  for (uint32_t i = 0; i < jobsArray.Length(); ++i) {
+    if (!parseJob(env, jobsArray.Get(i), defaults, &(*jobs)[i])) {
+      return env.Null();
+    }
+  }
+  
+  // Workers hand results over in completion order; a job only starts once
+  // its result has room, so at most one finished result per worker waits
+  // for the consumer and pool threads never wait on JS
+  return ResultStream::NewInstance(env, concurrency, "Error processing batch",
+      [jobs, concurrency, cancel](StreamSink& sink) {
+        // Workers claim the next unstarted job as they free up, so one slow
+        // document never holds back the rest
+        sink.ParallelFor(jobs->size(), concurrency, 1, [&jobs, &cancel](size_t, size_t index, StreamEmitter& emitter) {
+          if (emitter.Cancelled()) {
+            return;
+          }
+          // An aborted batch ends the stream instead of failing job by job
+          CheckCancelled(cancel);
+          
+          const BatchJob& job = (*jobs)[index];
+          auto result = std::make_unique<BatchResult>();
+          result->index = index;
+          result->text = job.text;
+          result->render = job.render;
+          
+          try {
+            runJob(job, *result, emitter, cancel);
+          } catch (const OperationCancelled&) {
+            throw;
+          } catch (const std::exception& e) {
+            // A failed job is reported in its result; the batch carries on
+            result->error = e.what();
+            result->texts.clear();
+            result->images.clear();
+          }
+          
+          emitter.Emit(std::move(result));
+        });
+      });
+}
@@ -0,0 +1,13 @@
+// src/cpp/batch.h
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <napi.h>
+
+// processBatch(jobs, options?) - loads, extracts and renders many documents
+// on the shared worker pool and returns a ResultStream that yields each
+// job's result as soon as it finishes. Each job gets its own document, so
+// throughput scales with cores rather than with documents.
+Napi::Value ProcessBatch(const Napi::CallbackInfo& info);
+
+#endif // BATCH_H
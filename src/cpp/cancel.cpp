@@ -0,0 +1,88 @@
+// src/cpp/cancel.cpp
+#include "cancel.h"
+#include "addon_data.h"
+#include <string>
+
+void CancelToken::SetTimeout(double timeoutMs) {
+  if (timeoutMs <= 0) {
+    hasDeadline_ = false;
+    return;
+  }
+  hasDeadline_ = true;
+  timeoutMs_ = timeoutMs;
+  deadline_ = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                 std::chrono::duration<double, std::milli>(timeoutMs));
+}
+
+void CancelToken::Check() const {
+  if (aborted_.load(std::memory_order_relaxed)) {
+    throw OperationCancelled("The operation was aborted");
+  }
+  if (hasDeadline_ && Clock::now() >= deadline_) {
+    throw OperationCancelled("Timed out after " + std::to_string(static_cast<long long>(timeoutMs_)) + " ms");
+  }
+}
+
+bool ParseCancelToken(Napi::Value options, std::shared_ptr<CancelToken>* token) {
+  token->reset();
+  if (!options.IsObject()) {
+    return true;
+  }
+  
+  Napi::Env env = options.Env();
+  Napi::Object object = options.As<Napi::Object>();
+  
+  Napi::Value signalValue = object.Get("signal");
+  Napi::Value timeoutValue = object.Get("timeoutMs");
+  bool hasSignal = !signalValue.IsUndefined() && !signalValue.IsNull();
+  bool hasTimeout = !timeoutValue.IsUndefined();
+  
+  if (!hasSignal && !hasTimeout) {
+    return true;
+  }
+  
+  auto result = std::make_shared<CancelToken>();
+  
+  if (hasTimeout) {
+    if (!timeoutValue.IsNumber() || timeoutValue.As<Napi::Number>().DoubleValue() < 0) {
+      Napi::TypeError::New(env, "Expected timeoutMs to be a non-negative number").ThrowAsJavaScriptException();
+      return false;
+    }
+    result->SetTimeout(timeoutValue.As<Napi::Number>().DoubleValue());
+  }
+  
+  if (hasSignal) {
+    if (!signalValue.IsObject() || !signalValue.As<Napi::Object>().Get("addEventListener").IsFunction()) {
+      Napi::TypeError::New(env, "Expected signal to be an AbortSignal").ThrowAsJavaScriptException();
+      return false;
+    }
+    
+    Napi::Object signal = signalValue.As<Napi::Object>();
+    Napi::Function addEventListener = signal.Get("addEventListener").As<Napi::Function>();
+    if (signal.Get("aborted").ToBoolean().Value()) {
+      result->Abort();
+    } else {
+      // The listener only watches the token: the token owns the listener's
+      // registration, and a strong reference back would keep both alive
+      std::weak_ptr<CancelToken> listenerToken = result;
+      Napi::Function listener = Napi::Function::New(env, [listenerToken](const Napi::CallbackInfo&) {
+        if (std::shared_ptr<CancelToken> token = listenerToken.lock()) {
+          token->Abort();
+        }
+      }, "onAbort");
+      
+      Napi::Object listenerOptions = Napi::Object::New(env);
+      listenerOptions.Set("once", Napi::Boolean::New(env, true));
+      addEventListener.Call(signal, {
+        Napi::String::New(env, "abort"), listener, listenerOptions
+      });
+      if (env.IsExceptionPending()) {
+        return false;
+      }
+      result->listener_ = PinEventListener(env, signal, "abort", listener);
+    }
+  }
+  
+  *token = std::move(result);
+  return true;
+}
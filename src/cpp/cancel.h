@@ -0,0 +1,60 @@
+// src/cpp/cancel.h
+#ifndef CANCEL_H
+#define CANCEL_H
+
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+// Thrown by CancelToken::Check() once an operation should stop
+class OperationCancelled : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+// Abort flag and deadline shared between the JS thread and the workers of
+// one async call. poppler cannot be interrupted inside a page, so workers
+// call Check() between pages, tiles and phases; a single pathological page
+// still runs to completion, but nothing after it starts. The token owns its
+// 'abort' listener, which is removed from the signal once the call that
+// holds the token settles, so a long-lived signal does not collect one
+// listener per call.
+class CancelToken {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Set from the AbortSignal's 'abort' listener on the JS thread
+  void Abort() { aborted_.store(true, std::memory_order_relaxed); }
+
+  // A timeout of 0 means no deadline
+  void SetTimeout(double timeoutMs);
+
+  // Throws OperationCancelled if the call was aborted or is past its deadline
+  void Check() const;
+
+private:
+  std::atomic<bool> aborted_{false};
+  bool hasDeadline_ = false;
+  double timeoutMs_ = 0;
+  Clock::time_point deadline_;
+  // Removes the signal's 'abort' listener when the token is dropped
+  std::shared_ptr<const void> listener_;
+  
+  friend bool ParseCancelToken(Napi::Value options, std::shared_ptr<CancelToken>* token);
+};
+
+// Reads { signal, timeoutMs } from a JS options object. Returns true with a
+// null token when neither is set, so callers that check `if (token)` pay
+// nothing. Throws a JS exception and returns false on invalid options.
+bool ParseCancelToken(Napi::Value options, std::shared_ptr<CancelToken>* token);
+
+// Convenience for call sites that may have no token
+inline void CheckCancelled(const std::shared_ptr<const CancelToken>& token) {
+  if (token) {
+    token->Check();
+  }
+}
+
+#endif // CANCEL_H
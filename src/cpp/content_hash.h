@@ -0,0 +1,18 @@
+// src/cpp/content_hash.h
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// XXH64 of `data`: a fast non-cryptographic hash used to recognise
+// documents with identical bytes. Four independent accumulators keep the
+// main loop at memory bandwidth; it is not meant to resist collisions
+// crafted on purpose.
+uint64_t ContentHash(const char* data, size_t length, uint64_t seed = 0);
+
+// 16 lowercase hex digits
+std::string ContentHashHex(uint64_t hash);
+
+#endif // CONTENT_HASH_H
@@ -2,8 +2,687 @@
 #include "document.h"
 #include "page.h"
 #include <poppler/cpp/poppler-document.h>
+#include <poppler/cpp/poppler-page.h>
+#include "addon_data.h"
+#include "async_task.h"
+#include "cancel.h"
+#include "content_hash.h"
+#include "mapped_file.h"
+#include "page_stream.h"
+#include "render.h"
+#include "render_stream.h"
+#include "search_index.h"
+#include "stats.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
 
-Napi::FunctionReference Document::constructor;
+namespace {
+
+// Extracts the text of many pages in one call. Each worker opens its own
+// copy of the document from the source, so pages are processed in parallel
+// without ever touching the Document's shared instance.
+class ExtractTextTask : public AsyncTask {
+public:
+  ExtractTextTask(Napi::Env env, DocumentSource source, std::vector<int> pages, size_t concurrency,
+                  std::shared_ptr<const CancelToken> cancel)
+      : AsyncTask(env), source_(std::move(source)), pages_(std::move(pages)),
+        concurrency_(concurrency), cancel_(std::move(cancel)) {}
+
+protected:
+  void Execute() override {
+    std::vector<std::unique_ptr<poppler::document>> docs(concurrency_);
+    texts_.resize(pages_.size());
+    
+    try {
+      ParallelFor(pages_.size(), concurrency_, [this, &docs](size_t worker, size_t index) {
+        CheckCancelled(cancel_);
+        std::unique_ptr<poppler::document>& doc = docs[worker];
+        if (!doc) {
+          doc = source_.Open();
+          if (!doc) {
+            throw std::runtime_error("Failed to open document on worker thread");
+          }
+        }
+        
+        std::unique_ptr<poppler::page> page;
+        {
+          StatsTimer timer(Stats::Global().pageCreate, "pageCreate");
+          page.reset(doc->create_page(pages_[index]));
+        }
+        if (!page) {
+          throw std::runtime_error("Failed to create page " + std::to_string(pages_[index]));
+        }
+        
+        StatsTimer timer(Stats::Global().textExtract, "textExtract");
+        poppler::byte_array utf8_bytes = page->text().to_utf8();
+        texts_[index].assign(utf8_bytes.data(), utf8_bytes.size());
+      });
+    } catch (const std::exception& e) {
+      SetError(std::string("Error extracting text: ") + e.what());
+    }
+  }
+  
+  Napi::Value OnOK(Napi::Env env) override {
+    Napi::Array result = Napi::Array::New(env, texts_.size());
+    for (size_t i = 0; i < texts_.size(); ++i) {
+      CountCopiedToJs(texts_[i].size());
+      result.Set(i, Napi::String::New(env, texts_[i]));
+    }
+    return result;
+  }
+
+private:
+  DocumentSource source_;
+  std::vector<int> pages_;
+  size_t concurrency_;
+  std::shared_ptr<const CancelToken> cancel_;
+  std::vector<std::string> texts_;
+};
+
+// Renders a batch of pages or page regions across worker threads. Like
+// ExtractTextTask, each worker opens its own copy of the document. With
+// `useTileCache`, tiles found in the document's tile cache are not
+// rendered again.
+class RenderBatchTask : public AsyncTask {
+public:
+  struct Tile {
+    int page;
+    RenderOptions options;
+  };
+
+  RenderBatchTask(Napi::Env env, std::shared_ptr<DocumentHandle> handle, DocumentSource source,
+                  int renderHints, std::vector<Tile> tiles, size_t concurrency, bool useTileCache,
+                  std::shared_ptr<const CancelToken> cancel)
+      : AsyncTask(env), handle_(std::move(handle)), source_(std::move(source)),
+        renderHints_(renderHints), tiles_(std::move(tiles)), concurrency_(concurrency),
+        useTileCache_(useTileCache), cancel_(std::move(cancel)) {}
+
+protected:
+  void Execute() override {
+    std::vector<Worker> workers(concurrency_);
+    outputs_.resize(tiles_.size());
+    
+    try {
+      ParallelFor(tiles_.size(), concurrency_, [this, &workers](size_t worker, size_t index) {
+        CheckCancelled(cancel_);
+        const Tile& tile = tiles_[index];
+        TileKey key(tile.page, renderHints_, tile.options);
+        
+        bool caching = useTileCache_ && handle_->tiles.Capacity() > 0;
+        
+        if (caching && handle_->tiles.Get(key, &outputs_[index])) {
+          return;
+        }
+        
+        Worker& state = workers[worker];
+        poppler::page* page = state.PageAt(source_, renderHints_, tile.page);
+        
+        RenderOutput& output = outputs_[index];
+        output.encoding = tile.options.encoding;
+        output.image = RenderPage(state.renderer, page, tile.options);
+        if (!output.image.is_valid()) {
+          throw std::runtime_error("Failed to render tile of page " + std::to_string(tile.page));
+        }
+        CheckCancelled(cancel_);
+        EncodeRenderOutput(output);
+        
+        if (caching) {
+          handle_->tiles.Put(key, output);
+        }
+      });
+    } catch (const std::exception& e) {
+      SetError(std::string("Error rendering tiles: ") + e.what());
+    }
+  }
+  
+  Napi::Value OnOK(Napi::Env env) override {
+    Napi::Array result = Napi::Array::New(env, outputs_.size());
+    for (size_t i = 0; i < outputs_.size(); ++i) {
+      result.Set(i, RenderOutputToObject(env, outputs_[i]));
+    }
+    return result;
+  }
+
+private:
+  // Per-thread document, renderer and the page last rendered, since
+  // consecutive tiles usually come from the same page
+  struct Worker {
+    std::unique_ptr<poppler::document> doc;
+    poppler::page_renderer renderer;
+    std::unique_ptr<poppler::page> page;
+    int pageIndex = -1;
+    
+    poppler::page* PageAt(const DocumentSource& source, int hints, int index) {
+      if (!doc) {
+        doc = source.Open();
+        if (!doc) {
+          throw std::runtime_error("Failed to open document on worker thread");
+        }
+        renderer.set_render_hints(hints);
+      }
+      if (index != pageIndex) {
+        StatsTimer timer(Stats::Global().pageCreate, "pageCreate");
+        page.reset(doc->create_page(index));
+        pageIndex = index;
+        if (!page) {
+          throw std::runtime_error("Failed to create page " + std::to_string(index));
+        }
+      }
+      return page.get();
+    }
+  };
+  
+  std::shared_ptr<DocumentHandle> handle_;
+  DocumentSource source_;
+  int renderHints_;
+  std::vector<Tile> tiles_;
+  size_t concurrency_;
+  bool useTileCache_;
+  std::shared_ptr<const CancelToken> cancel_;
+  std::vector<RenderOutput> outputs_;
+};
+
+// Builds a SearchIndex over every page. Word boxes are collected in
+// parallel, one document copy per worker, then added to the index in page
+// order.
+class BuildSearchIndexTask : public AsyncTask {
+public:
+  BuildSearchIndexTask(Napi::Env env, DocumentSource source, int pageCount, size_t concurrency,
+                       std::shared_ptr<const CancelToken> cancel)
+      : AsyncTask(env), source_(std::move(source)), pageCount_(pageCount), concurrency_(concurrency),
+        cancel_(std::move(cancel)) {}
+
+protected:
+  void Execute() override {
+    std::vector<std::unique_ptr<poppler::document>> docs(concurrency_);
+    std::vector<std::vector<IndexInputWord>> pages(pageCount_);
+    
+    try {
+      ParallelFor(pages.size(), concurrency_, [this, &docs, &pages](size_t worker, size_t index) {
+        CheckCancelled(cancel_);
+        std::unique_ptr<poppler::document>& doc = docs[worker];
+        if (!doc) {
+          doc = source_.Open();
+          if (!doc) {
+            throw std::runtime_error("Failed to open document on worker thread");
+          }
+        }
+        
+        std::unique_ptr<poppler::page> page;
+        {
+          StatsTimer timer(Stats::Global().pageCreate, "pageCreate");
+          page.reset(doc->create_page(static_cast<int>(index)));
+        }
+        if (!page) {
+          throw std::runtime_error("Failed to create page " + std::to_string(index));
+        }
+        
+        std::vector<poppler::text_box> boxes;
+        {
+          StatsTimer timer(Stats::Global().textExtract, "textExtract");
+          boxes = page->text_list();
+        }
+        std::vector<IndexInputWord>& words = pages[index];
+        words.reserve(boxes.size());
+        for (const auto& box : boxes) {
+          poppler::byte_array utf8_bytes = box.text().to_utf8();
+          poppler::rectf bbox = box.bbox();
+          words.push_back({ std::string(utf8_bytes.data(), utf8_bytes.size()),
+                            static_cast<float>(bbox.x()), static_cast<float>(bbox.y()),
+                            static_cast<float>(bbox.width()), static_cast<float>(bbox.height()) });
+        }
+      });
+      
+      CheckCancelled(cancel_);
+      index_ = std::make_shared<TextIndex>();
+      for (const auto& words : pages) {
+        index_->AddPage(words);
+      }
+    } catch (const std::exception& e) {
+      SetError(std::string("Error building search index: ") + e.what());
+    }
+  }
+  
+  Napi::Value OnOK(Napi::Env env) override {
+    return SearchIndex::NewInstance(env, index_);
+  }
+
+private:
+  DocumentSource source_;
+  int pageCount_;
+  size_t concurrency_;
+  std::shared_ptr<const CancelToken> cancel_;
+  std::shared_ptr<TextIndex> index_;
+};
+
+// Validates a JS array of page indices against the document's page count.
+// Throws a JS exception and returns false on bad input.
+bool parsePageList(Napi::Env env, Napi::Value value, int pageCount, std::vector<int>* pages) {
+  if (!value.IsArray()) {
+    Napi::TypeError::New(env, "Expected pages to be an array of page indices").ThrowAsJavaScriptException();
+    return false;
+  }
+  
+  Napi::Array pagesArray = value.As<Napi::Array>();
+  pages->reserve(pagesArray.Length());
+  for (uint32_t i = 0; i < pagesArray.Length(); ++i) {
+    Napi::Value indexValue = pagesArray.Get(i);
+    if (!indexValue.IsNumber()) {
+      Napi::TypeError::New(env, "Expected page number").ThrowAsJavaScriptException();
+      return false;
+    }
+    
+    int pageIndex = indexValue.As<Napi::Number>().Int32Value();
+    if (pageIndex < 0 || pageIndex >= pageCount) {
+      Napi::RangeError::New(env, "Page index out of range").ThrowAsJavaScriptException();
+      return false;
+    }
+    pages->push_back(pageIndex);
+  }
+  
+  return true;
+}
+
+// Parses a printer-style page range such as "1-50" or "1,3,7-" into page
+// indices. Page numbers start at 1 and an open end runs to the last page.
+// Throws a JS exception and returns false on bad input.
+bool parsePageRange(Napi::Env env, const std::string& range, int pageCount, std::vector<int>* pages) {
+  auto invalid = [&env, &range]() {
+    Napi::TypeError::New(env, "Invalid page range: " + range).ThrowAsJavaScriptException();
+    return false;
+  };
+  
+  size_t at = 0;
+  // Reads a page number; 0 when there are no digits
+  auto number = [&range, &at]() {
+    long value = 0;
+    while (at < range.size() && range[at] >= '0' && range[at] <= '9') {
+      value = std::min<long>(value * 10 + (range[at] - '0'), std::numeric_limits<int>::max());
+      ++at;
+    }
+    return static_cast<int>(value);
+  };
+  auto skipSpaces = [&range, &at]() {
+    while (at < range.size() && range[at] == ' ') {
+      ++at;
+    }
+  };
+  
+  while (true) {
+    skipSpaces();
+    int first = number();
+    if (first == 0) {
+      return invalid();
+    }
+    int last = first;
+    skipSpaces();
+    if (at < range.size() && range[at] == '-') {
+      ++at;
+      skipSpaces();
+      last = number();
+      if (last == 0) {
+        last = pageCount;
+      }
+      skipSpaces();
+    }
+    if (first > last) {
+      return invalid();
+    }
+    if (last > pageCount) {
+      Napi::RangeError::New(env, "Page range past the last page: " + range).ThrowAsJavaScriptException();
+      return false;
+    }
+    for (int page = first; page <= last; ++page) {
+      pages->push_back(page - 1);
+    }
+    
+    if (at == range.size()) {
+      return true;
+    }
+    if (range[at] != ',') {
+      return invalid();
+    }
+    ++at;
+  }
+}
+
+// Reads `concurrency` from an options value, defaulting to the pool size.
+// Larger values are clamped to the pool size: no more workers can run at
+// once, and callers size per-worker state (document copies) by it.
+// Throws a JS exception and returns false on bad input.
+bool parseConcurrency(Napi::Env env, Napi::Value options, size_t* concurrency) {
+  size_t poolSize = std::max<size_t>(WorkerPool::Shared().Concurrency(), 1);
+  *concurrency = poolSize;
+  if (!options.IsObject() || !options.As<Napi::Object>().Has("concurrency")) {
+    return true;
+  }
+  
+  Napi::Value concurrencyValue = options.As<Napi::Object>().Get("concurrency");
+  double requested = concurrencyValue.IsNumber() ? concurrencyValue.As<Napi::Number>().DoubleValue() : 0;
+  if (!(requested >= 1)) {
+    Napi::TypeError::New(env, "Expected concurrency to be a positive number").ThrowAsJavaScriptException();
+    return false;
+  }
+  if (requested < static_cast<double>(poolSize)) {
+    *concurrency = static_cast<size_t>(requested);
+  }
+  return true;
+}
+
+// Gives a document loaded by path its bytes in memory, read once. From then
+// on worker copies open those bytes too, so the content hash, the shared
+// buffer and async results all describe the same version of the file.
+// Caller must hold the handle's mutex.
+bool ensureSourceBytes(DocumentHandle& handle, std::string* error) {
+  DocumentSource& source = handle.source;
+  if (source.data) {
+    return true;
+  }
+  
+  std::ifstream file(source.path, std::ios::binary);
+  if (!file) {
+    *error = "Failed to open file";
+    return false;
+  }
+  auto bytes = std::make_shared<const std::vector<char>>(std::istreambuf_iterator<char>(file),
+                                                         std::istreambuf_iterator<char>());
+  if (file.bad()) {
+    *error = "Failed to read file";
+    return false;
+  }
+  
+  source.data = bytes->data();
+  source.length = bytes->size();
+  source.owner = bytes;
+  Stats::Global().documentBytes.fetch_add(static_cast<int64_t>(source.length), std::memory_order_relaxed);
+  // Idle copies were opened from the path, which may no longer match
+  handle.ClearSpares();
+  return true;
+}
+
+// Hashes the document's bytes once. Caller must hold the handle's mutex.
+bool ensureContentKey(DocumentHandle& handle, std::string* error) {
+  if (!handle.contentKey.empty()) {
+    return true;
+  }
+  
+  if (!ensureSourceBytes(handle, error)) {
+    return false;
+  }
+  handle.contentKey = ContentHashHex(ContentHash(handle.source.data, handle.source.length));
+  return true;
+}
+
+// Returns a Uint8Array over `value` when it is a SharedArrayBuffer or a
+// Uint8Array/Buffer backed by one, and an empty value otherwise
+Napi::Value sharedView(Napi::Env env, Napi::Value value) {
+  Napi::Value sharedArrayBuffer = env.Global().Get("SharedArrayBuffer");
+  if (!value.IsObject() || !sharedArrayBuffer.IsFunction()) {
+    return Napi::Value();
+  }
+  
+  Napi::Function sharedConstructor = sharedArrayBuffer.As<Napi::Function>();
+  if (value.As<Napi::Object>().InstanceOf(sharedConstructor)) {
+    Napi::Function uint8Array = env.Global().Get("Uint8Array").As<Napi::Function>();
+    return uint8Array.New({ value });
+  }
+  
+  if (value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array) {
+    Napi::Value buffer = value.As<Napi::Object>().Get("buffer");
+    if (buffer.IsObject() && buffer.As<Napi::Object>().InstanceOf(sharedConstructor)) {
+      return value;
+    }
+  }
+  return Napi::Value();
+}
+
+// The document's info dictionary as { key: value }. Caller must hold the
+// handle's mutex.
+Napi::Object metadataObject(Napi::Env env, const poppler::document& doc) {
+  Napi::Object metadata = Napi::Object::New(env);
+  
+  std::vector<std::string> keys = doc.info_keys();
+  for (const std::string& key : keys) {
+    poppler::ustring value = doc.info_key(key);
+    poppler::byte_array utf8_bytes = value.to_utf8();
+    std::string utf8_value(utf8_bytes.data(), utf8_bytes.size());
+    metadata.Set(key, Napi::String::New(env, utf8_value));
+  }
+  
+  return metadata;
+}
+
+// Values per page in getPageGeometries(): x, y, width, height, rotation,
+// duration
+const size_t kGeometryStride = 6;
+
+// Pages whose text probe() samples unless told otherwise
+const size_t kDefaultProbePages = 8;
+
+// Writes one page's geometry; a page poppler cannot load is all NaN
+void writeGeometry(poppler::document& doc, int index, double* out) {
+  std::unique_ptr<poppler::page> page;
+  {
+    StatsTimer timer(Stats::Global().pageCreate, "pageCreate");
+    page.reset(doc.create_page(index));
+  }
+  if (!page) {
+    std::fill(out, out + kGeometryStride, std::numeric_limits<double>::quiet_NaN());
+    return;
+  }
+  
+  poppler::rectf rect = page->page_rect();
+  out[0] = rect.x();
+  out[1] = rect.y();
+  out[2] = rect.width();
+  out[3] = rect.height();
+  out[4] = static_cast<double>(page->orientation());
+  out[5] = page->duration();
+}
+
+std::vector<int> allPageIndices(int pageCount) {
+  std::vector<int> pages;
+  pages.reserve(pageCount);
+  for (int i = 0; i < pageCount; ++i) {
+    pages.push_back(i);
+  }
+  return pages;
+}
+
+
+// Answers intake questions about a PDF without preparing it for use:
+// loading only reads the trailer and cross-reference table, and the text
+// of a sample of pages is extracted in parallel, one document copy per
+// worker. The input Buffer is pinned by the task instead of copied.
+class ProbeTask : public AsyncTask {
+public:
+  struct PageProbe {
+    int index;
+    size_t characters; // non-whitespace characters of text
+    double ms;         // time to parse the page and extract its text
+  };
+
+  ProbeTask(Napi::Env env, DocumentSource source, size_t maxPages, size_t concurrency,
+            std::shared_ptr<const CancelToken> cancel)
+      : AsyncTask(env), source_(std::move(source)), maxPages_(maxPages), concurrency_(concurrency),
+        cancel_(std::move(cancel)) {}
+
+protected:
+  void Execute() override {
+    try {
+      CheckCancelled(cancel_);
+      std::unique_ptr<poppler::document> doc = source_.Open();
+      if (!doc) {
+        throw std::runtime_error("Failed to load PDF document");
+      }
+      
+      locked_ = doc->is_locked();
+      encrypted_ = doc->is_encrypted();
+      doc->get_pdf_version(&major_, &minor_);
+      pageCount_ = doc->pages();
+      imageCount_ = countImageXObjects(source_.data, source_.length);
+      if (locked_) {
+        return;
+      }
+      
+      for (const std::string& key : doc->info_keys()) {
+        poppler::byte_array utf8_bytes = doc->info_key(key).to_utf8();
+        metadata_.emplace_back(key, std::string(utf8_bytes.data(), utf8_bytes.size()));
+      }
+      
+      std::vector<int> sample = samplePages(pageCount_, maxPages_);
+      pages_.resize(sample.size());
+      size_t concurrency = std::min(concurrency_, std::max<size_t>(sample.size(), 1));
+      std::vector<std::unique_ptr<poppler::document>> docs(concurrency);
+      // The document already loaded serves the first worker
+      docs[0] = std::move(doc);
+      
+      ParallelFor(sample.size(), concurrency, [this, &docs, &sample](size_t worker, size_t index) {
+        CheckCancelled(cancel_);
+        std::unique_ptr<poppler::document>& doc = docs[worker];
+        if (!doc) {
+          doc = source_.Open();
+          if (!doc) {
+            throw std::runtime_error("Failed to open document on worker thread");
+          }
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<poppler::page> page;
+        {
+          StatsTimer timer(Stats::Global().pageCreate, "pageCreate");
+          page.reset(doc->create_page(sample[index]));
+        }
+        size_t characters = 0;
+        if (page) {
+          StatsTimer timer(Stats::Global().textExtract, "textExtract");
+          characters = countCharacters(page->text().to_utf8());
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        pages_[index] = { sample[index], characters, ms };
+      });
+    } catch (const std::exception& e) {
+      SetError(std::string("Error probing document: ") + e.what());
+    }
+  }
+  
+  Napi::Value OnOK(Napi::Env env) override {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("pageCount", Napi::Number::New(env, pageCount_));
+    result.Set("locked", Napi::Boolean::New(env, locked_));
+    result.Set("encrypted", Napi::Boolean::New(env, encrypted_));
+    result.Set("version", Napi::String::New(env, std::to_string(major_) + "." + std::to_string(minor_)));
+    result.Set("imageCount", Napi::Number::New(env, static_cast<double>(imageCount_)));
+    
+    Napi::Object metadata = Napi::Object::New(env);
+    for (const auto& entry : metadata_) {
+      metadata.Set(entry.first, Napi::String::New(env, entry.second));
+    }
+    result.Set("metadata", metadata);
+    
+    bool anyText = false;
+    Napi::Array pages = Napi::Array::New(env, pages_.size());
+    for (size_t i = 0; i < pages_.size(); ++i) {
+      const PageProbe& probe = pages_[i];
+      anyText = anyText || probe.characters > 0;
+      Napi::Object page = Napi::Object::New(env);
+      page.Set("index", Napi::Number::New(env, probe.index));
+      page.Set("hasText", Napi::Boolean::New(env, probe.characters > 0));
+      page.Set("characters", Napi::Number::New(env, static_cast<double>(probe.characters)));
+      page.Set("ms", Napi::Number::New(env, probe.ms));
+      pages.Set(static_cast<uint32_t>(i), page);
+    }
+    result.Set("pages", pages);
+    // Images but no text on any sampled page: a candidate for OCR
+    result.Set("likelyScanned", Napi::Boolean::New(env, !pages_.empty() && !anyText && imageCount_ > 0));
+    
+    return result;
+  }
+
+private:
+  // Up to `maxPages` indices spread evenly from the first page to the
+  // last; every page when `maxPages` is 0
+  static std::vector<int> samplePages(int pageCount, size_t maxPages) {
+    std::vector<int> sample;
+    if (pageCount <= 0) {
+      return sample;
+    }
+    size_t count = static_cast<size_t>(pageCount);
+    if (maxPages == 0 || maxPages >= count) {
+      return allPageIndices(pageCount);
+    }
+    for (size_t i = 0; i < maxPages; ++i) {
+      sample.push_back(maxPages == 1 ? 0 : static_cast<int>(i * (count - 1) / (maxPages - 1)));
+    }
+    return sample;
+  }
+  
+  static size_t countCharacters(const poppler::byte_array& utf8) {
+    size_t count = 0;
+    for (char c : utf8) {
+      unsigned char byte = static_cast<unsigned char>(c);
+      // Skips UTF-8 continuation bytes and ASCII whitespace
+      if ((byte & 0xC0) != 0x80 && byte != ' ' && byte != '\t' && byte != '\n' && byte != '\r' &&
+          byte != '\f') {
+        ++count;
+      }
+    }
+    return count;
+  }
+  
+  // Counts image XObjects by looking for "/Subtype /Image" in the raw
+  // bytes. Streams may not be stored inside object streams and encryption
+  // leaves dictionary keys and names alone, so every image's dictionary is
+  // visible without parsing anything.
+  static size_t countImageXObjects(const char* data, size_t length) {
+    static const std::string_view kSubtype = "/Subtype";
+    static const std::string_view kImage = "/Image";
+    auto isSpace = [](char c) {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\0';
+    };
+    
+    std::string_view bytes(data, length);
+    size_t count = 0;
+    for (size_t at = bytes.find(kSubtype); at != std::string_view::npos; at = bytes.find(kSubtype, at)) {
+      at += kSubtype.size();
+      while (at < bytes.size() && isSpace(bytes[at])) {
+        ++at;
+      }
+      if (bytes.substr(at, kImage.size()) != kImage) {
+        continue;
+      }
+      // "/Image" must end here, not continue as a longer name
+      size_t end = at + kImage.size();
+      if (end == bytes.size() || isSpace(bytes[end]) ||
+          std::string_view("/<>[]()%").find(bytes[end]) != std::string_view::npos) {
+        ++count;
+      }
+    }
+    return count;
+  }
+  
+  DocumentSource source_;
+  size_t maxPages_;
+  size_t concurrency_;
+  std::shared_ptr<const CancelToken> cancel_;
+  bool locked_ = false;
+  bool encrypted_ = false;
+  int major_ = 0;
+  int minor_ = 0;
+  int pageCount_ = 0;
+  size_t imageCount_ = 0;
+  std::vector<std::pair<std::string, std::string>> metadata_;
+  std::vector<PageProbe> pages_;
+};
+
+} // namespace
 
 Napi::Object Document::Init(Napi::Env env, Napi::Object exports) {
   Napi::HandleScope scope(env);
@@ -11,15 +690,32 @@ Napi::Object Document::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func = DefineClass(env, "Document", {
     StaticMethod("loadFromFile", &Document::LoadFromFile),
     StaticMethod("loadFromBuffer", &Document::LoadFromBuffer),
+    StaticMethod("probe", &Document::Probe),
     InstanceMethod("getPageCount", &Document::GetPageCount),
     InstanceMethod("getPage", &Document::GetPage),
     InstanceMethod("getMetadata", &Document::GetMetadata),
+    InstanceMethod("getPageGeometries", &Document::GetPageGeometries),
     InstanceMethod("isLocked", &Document::IsLocked),
-    InstanceMethod("unlock", &Document::Unlock)
+    InstanceMethod("unlock", &Document::Unlock),
+    InstanceMethod("extractTextAsync", &Document::ExtractTextAsync),
+    InstanceMethod("pages", &Document::Pages),
+    InstanceMethod("renderPages", &Document::RenderPages),
+    InstanceMethod("renderTilesAsync", &Document::RenderTilesAsync),
+    InstanceMethod("renderThumbnails", &Document::RenderThumbnails),
+    InstanceMethod("buildSearchIndex", &Document::BuildSearchIndex),
+    InstanceMethod("setExtractionCache", &Document::SetExtractionCache),
+    InstanceMethod("getContentHash", &Document::GetContentHash),
+    InstanceMethod("getSharedBuffer", &Document::GetSharedBuffer),
+    InstanceMethod("setTileCacheSize", &Document::SetTileCacheSize),
+    InstanceMethod("getTileCacheStats", &Document::GetTileCacheStats),
+    InstanceMethod("setPageCacheSize", &Document::SetPageCacheSize),
+    InstanceMethod("getPageCacheStats", &Document::GetPageCacheStats),
+    InstanceMethod("setRenderHints", &Document::SetRenderHints),
+    InstanceMethod("dispose", &Document::Dispose)
   });
+  DefineDisposeSymbol(env, func);
   
-  constructor = Napi::Persistent(func);
-  constructor.SuppressDestruct();
+  AddonData::Get(env)->documentConstructor = Napi::Persistent(func);
   
   exports.Set("Document", func);
   return exports;
@@ -29,6 +725,34 @@ Document::Document(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Document>(
   // Private constructor - use static factory methods
 }
 
+Document::~Document() {
+  ReportExternalMemory(Env(), -externalBytes_);
+}
+
+Napi::Value Document::Dispose(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (handle_) {
+    {
+      // Cached pages and tiles only serve this Document's own calls
+      std::lock_guard<std::mutex> lock(handle_->mutex);
+      handle_->pages.Clear();
+    }
+    handle_->tiles.Clear();
+    // Pages handed out and async calls in flight keep their own
+    // references; the native document is freed when the last one lets go
+    handle_.reset();
+  }
+  
+  sharedBuffer_.Reset();
+  geometries_.clear();
+  geometriesReady_ = false;
+  ReportExternalMemory(env, -externalBytes_);
+  externalBytes_ = 0;
+  
+  return env.Undefined();
+}
+
 Napi::Value Document::LoadFromFile(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   
@@ -39,20 +763,41 @@ Napi::Value Document::LoadFromFile(const Napi::CallbackInfo& info) {
   
   std::string filepath = info[0].As<Napi::String>().Utf8Value();
   std::string password = "";
+  bool useMmap = false;
   
   if (info.Length() > 1 && info[1].IsString()) {
     password = info[1].As<Napi::String>().Utf8Value();
   }
   
+  // Options may follow the password or take its place
+  Napi::Value optionsValue = info[1].IsObject() ? info[1] : info[2];
+  if (optionsValue.IsObject()) {
+    Napi::Object options = optionsValue.As<Napi::Object>();
+    if (options.Has("mmap")) {
+      useMmap = options.Get("mmap").ToBoolean().Value();
+    }
+  }
+  
   try {
-    poppler::document* raw_doc;
-    if (password.empty()) {
-      raw_doc = poppler::document::load_from_file(filepath);
-    } else {
-      raw_doc = poppler::document::load_from_file(filepath, password);
+    DocumentSource source;
+    source.path = filepath;
+    source.password = password;
+    
+    if (useMmap) {
+      std::string error;
+      std::shared_ptr<MappedFile> mapping = MappedFile::Open(filepath, &error);
+      if (!mapping) {
+        Napi::Error::New(env, "Failed to load PDF document: " + error).ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      // poppler parses straight out of the mapping, which stays pinned for
+      // as long as the document or any worker copy needs it
+      source.data = mapping->Data();
+      source.length = mapping->Length();
+      source.owner = mapping;
     }
     
-    std::unique_ptr<poppler::document> doc(raw_doc);
+    std::unique_ptr<poppler::document> doc = source.Open();
     
     if (!doc) {
       Napi::Error::New(env, "Failed to load PDF document").ThrowAsJavaScriptException();
@@ -60,9 +805,9 @@ Napi::Value Document::LoadFromFile(const Napi::CallbackInfo& info) {
     }
     
     // Create new Document instance
-    Napi::Object instance = constructor.New({});
+    Napi::Object instance = AddonData::Get(env)->documentConstructor.New({});
     Document* docWrapper = Napi::ObjectWrap<Document>::Unwrap(instance);
-    docWrapper->doc_ = std::shared_ptr<poppler::document>(doc.release());
+    docWrapper->handle_ = std::make_shared<DocumentHandle>(std::move(doc), std::move(source));
     
     return instance;
   } catch (const std::exception& e) {
@@ -74,27 +819,64 @@ Napi::Value Document::LoadFromFile(const Napi::CallbackInfo& info) {
 Napi::Value Document::LoadFromBuffer(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   
-  if (info.Length() < 1 || !info[0].IsBuffer()) {
-    Napi::TypeError::New(env, "Expected Buffer").ThrowAsJavaScriptException();
+  Napi::Value shared = info.Length() > 0 ? sharedView(env, info[0]) : Napi::Value();
+  if (env.IsExceptionPending()) {
+    return env.Null();
+  }
+  
+  if (shared.IsEmpty() && (info.Length() < 1 || !info[0].IsBuffer())) {
+    Napi::TypeError::New(env, "Expected Buffer or SharedArrayBuffer").ThrowAsJavaScriptException();
     return env.Null();
   }
   
-  Napi::Buffer<char> buffer = info[0].As<Napi::Buffer<char>>();
   std::string password = "";
+  bool copy = true;
   
   if (info.Length() > 1 && info[1].IsString()) {
     password = info[1].As<Napi::String>().Utf8Value();
   }
   
+  // Options may follow the password or take its place
+  Napi::Value optionsValue = info[1].IsObject() ? info[1] : info[2];
+  if (optionsValue.IsObject()) {
+    Napi::Object options = optionsValue.As<Napi::Object>();
+    if (options.Has("copy")) {
+      copy = options.Get("copy").ToBoolean().Value();
+    }
+  }
+  
   try {
-    poppler::document* raw_doc;
-    if (password.empty()) {
-      raw_doc = poppler::document::load_from_raw_data(buffer.Data(), buffer.Length());
+    DocumentSource source;
+    source.password = password;
+    bool borrowed = !shared.IsEmpty() || !copy;
+    
+    if (!shared.IsEmpty()) {
+      // Shared memory is borrowed rather than copied: every worker that
+      // opens the same SharedArrayBuffer parses the one set of bytes. The
+      // pin keeps it alive for the handle and any worker copies; V8 already
+      // counts it, so it is not reported as external memory.
+      Napi::Uint8Array view = shared.As<Napi::Uint8Array>();
+      source.data = reinterpret_cast<const char*>(view.Data());
+      source.length = view.ByteLength();
+      source.owner = PinJsObject(env, view);
+    } else if (!copy) {
+      // The Buffer is pinned for as long as the document (or a worker copy)
+      // reads from it; the caller must not modify it in the meantime
+      Napi::Buffer<char> buffer = info[0].As<Napi::Buffer<char>>();
+      source.data = buffer.Data();
+      source.length = buffer.Length();
+      source.owner = PinJsObject(env, buffer);
     } else {
-      raw_doc = poppler::document::load_from_raw_data(buffer.Data(), buffer.Length(), password);
+      // poppler reads from the raw data lazily and worker threads reopen it,
+      // so the document keeps its own copy instead of borrowing the Buffer
+      Napi::Buffer<char> buffer = info[0].As<Napi::Buffer<char>>();
+      auto bytes = std::make_shared<const std::vector<char>>(buffer.Data(), buffer.Data() + buffer.Length());
+      source.data = bytes->data();
+      source.length = bytes->size();
+      source.owner = bytes;
     }
     
-    std::unique_ptr<poppler::document> doc(raw_doc);
+    std::unique_ptr<poppler::document> doc = source.Open();
     
     if (!doc) {
       Napi::Error::New(env, "Failed to load PDF document from buffer").ThrowAsJavaScriptException();
@@ -102,9 +884,17 @@ Napi::Value Document::LoadFromBuffer(const Napi::CallbackInfo& info) {
     }
     
     // Create new Document instance
-    Napi::Object instance = constructor.New({});
+    Napi::Object instance = AddonData::Get(env)->documentConstructor.New({});
     Document* docWrapper = Napi::ObjectWrap<Document>::Unwrap(instance);
-    docWrapper->doc_ = std::shared_ptr<poppler::document>(doc.release());
+    docWrapper->handle_ = std::make_shared<DocumentHandle>(std::move(doc), std::move(source));
+    
+    if (!shared.IsEmpty()) {
+      docWrapper->sharedBuffer_ = Napi::Persistent(shared.As<Napi::Object>().Get("buffer").As<Napi::Object>());
+    } else if (!borrowed) {
+      // The copy lives as long as the handle, which this Document keeps alive
+      docWrapper->externalBytes_ = static_cast<int64_t>(docWrapper->handle_->source.length);
+      ReportExternalMemory(env, docWrapper->externalBytes_);
+    }
     
     return instance;
   } catch (const std::exception& e) {
@@ -113,25 +903,80 @@ Napi::Value Document::LoadFromBuffer(const Napi::CallbackInfo& info) {
   }
 }
 
+Napi::Value Document::Probe(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  Napi::Value shared = info.Length() > 0 ? sharedView(env, info[0]) : Napi::Value();
+  if (env.IsExceptionPending()) {
+    return env.Null();
+  }
+  
+  if (shared.IsEmpty() && (info.Length() < 1 || !info[0].IsBuffer())) {
+    Napi::TypeError::New(env, "Expected Buffer or SharedArrayBuffer").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  size_t concurrency;
+  std::shared_ptr<CancelToken> cancel;
+  if (!parseConcurrency(env, info[1], &concurrency) || !ParseCancelToken(info[1], &cancel)) {
+    return env.Null();
+  }
+  
+  DocumentSource source;
+  size_t maxPages = kDefaultProbePages;
+  
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+    
+    if (options.Has("password")) {
+      source.password = options.Get("password").ToString().Utf8Value();
+    }
+    if (options.Has("maxPages")) {
+      Napi::Value value = options.Get("maxPages");
+      double requested = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+      if (!(requested >= 0)) {
+        Napi::TypeError::New(env, "maxPages must be a non-negative number").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      // Page counts are ints, so anything larger samples every page
+      maxPages = static_cast<size_t>(std::min(requested, static_cast<double>(std::numeric_limits<int>::max())));
+    }
+  }
+  
+  // The bytes are only read for the lifetime of the task, so they are
+  // borrowed rather than copied
+  Napi::Uint8Array view = shared.IsEmpty() ? info[0].As<Napi::Uint8Array>() : shared.As<Napi::Uint8Array>();
+  source.data = reinterpret_cast<const char*>(view.Data());
+  source.length = view.ByteLength();
+  source.owner = PinJsObject(env, view);
+  
+  ProbeTask* task = new ProbeTask(env, std::move(source), maxPages, concurrency, cancel);
+  return task->Queue();
+}
+
 Napi::Value Document::GetPageCount(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   
-  if (!doc_) {
+  if (!handle_) {
     Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
     return env.Null();
   }
   
-  return Napi::Number::New(env, doc_->pages());
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  return Napi::Number::New(env, handle_->doc->pages());
 }
 
 Napi::Value Document::GetPage(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   
-  if (!doc_) {
+  if (!handle_) {
     Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
     return env.Null();
   }
   
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
   if (info.Length() < 1 || !info[0].IsNumber()) {
     Napi::TypeError::New(env, "Expected page number").ThrowAsJavaScriptException();
     return env.Null();
@@ -139,68 +984,620 @@ Napi::Value Document::GetPage(const Napi::CallbackInfo& info) {
   
   int pageIndex = info[0].As<Napi::Number>().Int32Value();
   
-  if (pageIndex < 0 || pageIndex >= doc_->pages()) {
+  if (pageIndex < 0 || pageIndex >= handle_->doc->pages()) {
     Napi::RangeError::New(env, "Page index out of range").ThrowAsJavaScriptException();
     return env.Null();
   }
   
-  std::unique_ptr<poppler::page> page(doc_->create_page(pageIndex));
+  std::shared_ptr<poppler::page> page = handle_->pages.Get(*handle_->doc, pageIndex);
   if (!page) {
     Napi::Error::New(env, "Failed to create page").ThrowAsJavaScriptException();
     return env.Null();
   }
   
-  return Page::NewInstance(env, std::move(page));
+  return Page::NewInstance(env, info.This().As<Napi::Object>(), handle_, std::move(page), pageIndex);
 }
 
 Napi::Value Document::GetMetadata(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   
-  if (!doc_) {
+  if (!handle_) {
     Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
     return env.Null();
   }
   
-  Napi::Object metadata = Napi::Object::New(env);
+  std::lock_guard<std::mutex> lock(handle_->mutex);
   
-  // Get document info
-  std::vector<std::string> keys = doc_->info_keys();
-  for (const std::string& key : keys) {
-    poppler::ustring value = doc_->info_key(key);
-    poppler::byte_array utf8_bytes = value.to_utf8();
-    std::string utf8_value(utf8_bytes.data(), utf8_bytes.size());
-    metadata.Set(key, Napi::String::New(env, utf8_value));
+  return metadataObject(env, *handle_->doc);
+}
+
+Napi::Value Document::GetPageGeometries(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
   }
   
-  return metadata;
+  try {
+    std::lock_guard<std::mutex> lock(handle_->mutex);
+    
+    // Read from the open document: a page_rect() is cheap next to parsing
+    // the file again on another thread
+    if (!geometriesReady_) {
+      int pageCount = handle_->doc->pages();
+      size_t count = pageCount > 0 ? static_cast<size_t>(pageCount) : 0;
+      std::vector<double> geometries(count * kGeometryStride);
+      for (size_t i = 0; i < count; ++i) {
+        writeGeometry(*handle_->doc, static_cast<int>(i), geometries.data() + i * kGeometryStride);
+      }
+      geometries_ = std::move(geometries);
+      geometriesReady_ = true;
+    }
+    
+    // Each call gets its own array, so one caller cannot change another's
+    size_t count = geometries_.size() / kGeometryStride;
+    Napi::Float64Array geometry = Napi::Float64Array::New(env, geometries_.size());
+    std::copy(geometries_.begin(), geometries_.end(), geometry.Data());
+    
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("pageCount", Napi::Number::New(env, static_cast<double>(count)));
+    result.Set("stride", Napi::Number::New(env, static_cast<double>(kGeometryStride)));
+    result.Set("geometry", geometry);
+    result.Set("metadata", metadataObject(env, *handle_->doc));
+    return result;
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, std::string("Error reading page geometries: ") + e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
 }
 
 Napi::Value Document::IsLocked(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   
-  if (!doc_) {
+  if (!handle_) {
     Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
     return env.Null();
   }
   
-  return Napi::Boolean::New(env, doc_->is_locked());
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  return Napi::Boolean::New(env, handle_->doc->is_locked());
 }
 
 Napi::Value Document::Unlock(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   
-  if (!doc_) {
+  if (!handle_) {
     Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
     return env.Null();
   }
   
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
   if (info.Length() < 1 || !info[0].IsString()) {
     Napi::TypeError::New(env, "Expected password string").ThrowAsJavaScriptException();
     return env.Null();
   }
   
   std::string password = info[0].As<Napi::String>().Utf8Value();
-  bool success = doc_->unlock(password, password); // owner_password, user_password
+  bool success = handle_->doc->unlock(password, password); // owner_password, user_password
+  if (success) {
+    // Documents reopened on worker threads need the same password
+    handle_->source.password = password;
+    // Computed while locked, so possibly without the real pages
+    geometries_.clear();
+    geometriesReady_ = false;
+  }
   
   return Napi::Boolean::New(env, success);
+}
+
+Napi::Value Document::ExtractTextAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  size_t concurrency;
+  std::shared_ptr<CancelToken> cancel;
+  if (!parseConcurrency(env, info[0], &concurrency) || !ParseCancelToken(info[0], &cancel)) {
+    return env.Null();
+  }
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  int pageCount = handle_->doc->pages();
+  std::vector<int> pages;
+  bool allPages = true;
+  
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
+    
+    if (options.Has("pages")) {
+      allPages = false;
+      if (!parsePageList(env, options.Get("pages"), pageCount, &pages)) {
+        return env.Null();
+      }
+    }
+  }
+  
+  if (allPages) {
+    pages = allPageIndices(pageCount);
+  }
+  
+  ExtractTextTask* task = new ExtractTextTask(env, handle_->source, std::move(pages), concurrency, cancel);
+  return task->Queue();
+}
+
+Napi::Value Document::Pages(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  PageStreamOptions streamOptions;
+  bool allPages = true;
+  
+  std::shared_ptr<CancelToken> cancel;
+  if (!ParseCancelToken(info[0], &cancel)) {
+    return env.Null();
+  }
+  streamOptions.cancel = cancel;
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  int pageCount = handle_->doc->pages();
+  
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
+    
+    if (options.Has("pages")) {
+      allPages = false;
+      if (!parsePageList(env, options.Get("pages"), pageCount, &streamOptions.pages)) {
+        return env.Null();
+      }
+    }
+    
+    if (options.Has("text")) {
+      streamOptions.text = options.Get("text").ToBoolean();
+    }
+    
+    if (options.Has("boxes")) {
+      streamOptions.boxes = options.Get("boxes").ToBoolean();
+    }
+    
+    if (options.Has("render")) {
+      Napi::Value renderValue = options.Get("render");
+      streamOptions.render = renderValue.ToBoolean();
+      if (!ParseRenderOptions(renderValue, &streamOptions.renderOptions)) {
+        return env.Null();
+      }
+    }
+    
+    if (options.Has("prefetch")) {
+      Napi::Value prefetchValue = options.Get("prefetch");
+      if (!prefetchValue.IsNumber() || prefetchValue.As<Napi::Number>().Int32Value() < 1) {
+        Napi::TypeError::New(env, "Expected prefetch to be a positive number").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      streamOptions.prefetch = prefetchValue.As<Napi::Number>().Uint32Value();
+    }
+  }
+  
+  if (allPages) {
+    streamOptions.pages = allPageIndices(pageCount);
+  }
+  
+  // The producer renders with its own renderer, so carry over the hints
+  // set through setRenderHints()
+  streamOptions.renderHints = handle_->renderer.render_hints();
+  
+  return NewPageStream(env, handle_->source, std::move(streamOptions));
+}
+
+Napi::Value Document::RenderPages(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  if (info.Length() < 1 || !info[0].IsObject() || !info[0].As<Napi::Object>().Get("outputs").IsArray()) {
+    Napi::TypeError::New(env, "Expected options with an outputs array").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  
+  RenderStreamOptions streamOptions;
+  std::shared_ptr<CancelToken> cancel;
+  if (!parseConcurrency(env, options, &streamOptions.concurrency) || !ParseCancelToken(options, &cancel)) {
+    return env.Null();
+  }
+  streamOptions.cancel = cancel;
+  
+  Napi::Array outputs = options.Get("outputs").As<Napi::Array>();
+  if (outputs.Length() == 0) {
+    Napi::TypeError::New(env, "Expected at least one output").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  streamOptions.outputs.resize(outputs.Length());
+  for (uint32_t i = 0; i < outputs.Length(); ++i) {
+    if (!ParseRenderOptions(outputs.Get(i), &streamOptions.outputs[i])) {
+      return env.Null();
+    }
+  }
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  int pageCount = handle_->doc->pages();
+  Napi::Value pagesValue = options.Get("pages");
+  if (pagesValue.IsString()) {
+    if (!parsePageRange(env, pagesValue.As<Napi::String>().Utf8Value(), pageCount, &streamOptions.pages)) {
+      return env.Null();
+    }
+  } else if (!pagesValue.IsUndefined()) {
+    if (!parsePageList(env, pagesValue, pageCount, &streamOptions.pages)) {
+      return env.Null();
+    }
+  } else {
+    streamOptions.pages = allPageIndices(pageCount);
+  }
+  
+  // No more workers than pages: each one opens a document copy
+  streamOptions.concurrency = std::max<size_t>(std::min(streamOptions.concurrency, streamOptions.pages.size()), 1);
+  // Workers render with their own renderers, so carry over the hints set
+  // through setRenderHints()
+  streamOptions.renderHints = handle_->renderer.render_hints();
+  
+  return NewRenderStream(env, handle_->source, std::move(streamOptions));
+}
+
+Napi::Value Document::RenderTilesAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of tiles").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  RenderOptions baseOptions;
+  if (!ParseRenderOptions(info[1], &baseOptions)) {
+    return env.Null();
+  }
+  
+  size_t concurrency;
+  std::shared_ptr<CancelToken> cancel;
+  if (!parseConcurrency(env, info[1], &concurrency) || !ParseCancelToken(info[1], &cancel)) {
+    return env.Null();
+  }
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  int pageCount = handle_->doc->pages();
+  Napi::Array tilesArray = info[0].As<Napi::Array>();
+  std::vector<RenderBatchTask::Tile> tiles;
+  tiles.reserve(tilesArray.Length());
+  
+  for (uint32_t i = 0; i < tilesArray.Length(); ++i) {
+    Napi::Value tileValue = tilesArray.Get(i);
+    if (!tileValue.IsObject()) {
+      Napi::TypeError::New(env, "Expected tile to be an object").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    
+    // A tile is a region plus the page it is on
+    Napi::Object tile = tileValue.As<Napi::Object>();
+    Napi::Object tileOptions = Napi::Object::New(env);
+    tileOptions.Set("region", tile);
+    
+    Napi::Value pageValue = tile.Get("page");
+    if (!pageValue.IsNumber()) {
+      Napi::TypeError::New(env, "Expected tile page to be a page index").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    
+    RenderBatchTask::Tile entry{ pageValue.As<Napi::Number>().Int32Value(), baseOptions };
+    if (!ParseRenderOptions(tileOptions, &entry.options)) {
+      return env.Null();
+    }
+    
+    if (entry.page < 0 || entry.page >= pageCount) {
+      Napi::RangeError::New(env, "Page index out of range").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    tiles.push_back(entry);
+  }
+  
+  RenderBatchTask* task = new RenderBatchTask(env, handle_, handle_->source,
+                                              handle_->renderer.render_hints(),
+                                              std::move(tiles), concurrency, true, cancel);
+  return task->Queue();
+}
+
+Napi::Value Document::RenderThumbnails(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  if (info.Length() < 1 || !info[0].IsNumber() || info[0].As<Napi::Number>().Int32Value() < 1) {
+    Napi::TypeError::New(env, "Expected thumbnail size to be a positive number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int size = info[0].As<Napi::Number>().Int32Value();
+  
+  // Thumbnail profile first, then whatever the caller overrides
+  Napi::Object defaults = Napi::Object::New(env);
+  defaults.Set("profile", "thumbnail");
+  RenderOptions options;
+  if (!ParseRenderOptions(defaults, &options) || !ParseRenderOptions(info[1], &options)) {
+    return env.Null();
+  }
+  options.fitWidth = size;
+  options.fitHeight = size;
+  
+  size_t concurrency;
+  std::shared_ptr<CancelToken> cancel;
+  if (!parseConcurrency(env, info[1], &concurrency) || !ParseCancelToken(info[1], &cancel)) {
+    return env.Null();
+  }
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  int pageCount = handle_->doc->pages();
+  std::vector<int> pages;
+  if (info[1].IsObject() && info[1].As<Napi::Object>().Has("pages")) {
+    if (!parsePageList(env, info[1].As<Napi::Object>().Get("pages"), pageCount, &pages)) {
+      return env.Null();
+    }
+  } else {
+    pages = allPageIndices(pageCount);
+  }
+  
+  std::vector<RenderBatchTask::Tile> thumbnails;
+  thumbnails.reserve(pages.size());
+  for (int page : pages) {
+    thumbnails.push_back({ page, options });
+  }
+  
+  RenderBatchTask* task = new RenderBatchTask(env, handle_, handle_->source,
+                                              handle_->renderer.render_hints(),
+                                              std::move(thumbnails), concurrency, false, cancel);
+  return task->Queue();
+}
+
+Napi::Value Document::BuildSearchIndex(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  size_t concurrency;
+  std::shared_ptr<CancelToken> cancel;
+  if (!parseConcurrency(env, info[0], &concurrency) || !ParseCancelToken(info[0], &cancel)) {
+    return env.Null();
+  }
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  BuildSearchIndexTask* task = new BuildSearchIndexTask(env, handle_->source, handle_->doc->pages(),
+                                                        concurrency, cancel);
+  return task->Queue();
+}
+
+Napi::Value Document::SetExtractionCache(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  if (info.Length() < 1 || !(info[0].IsString() || info[0].IsNull())) {
+    Napi::TypeError::New(env, "Expected cache directory or null").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  if (info[0].IsNull()) {
+    handle_->extraction.reset();
+    return env.Undefined();
+  }
+  
+  std::string error;
+  if (!ensureContentKey(*handle_, &error)) {
+    Napi::Error::New(env, "Failed to hash document: " + error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  handle_->extraction = std::make_shared<const ExtractionCache>(info[0].As<Napi::String>().Utf8Value());
+  return env.Undefined();
+}
+
+Napi::Value Document::GetContentHash(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  std::string error;
+  if (!ensureContentKey(*handle_, &error)) {
+    Napi::Error::New(env, "Failed to hash document: " + error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  return Napi::String::New(env, handle_->contentKey);
+}
+
+Napi::Value Document::GetSharedBuffer(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  if (!sharedBuffer_.IsEmpty()) {
+    return sharedBuffer_.Value();
+  }
+  
+  // Copied once; documents opened from the result (in this thread or a
+  // worker) then share it without further copies
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  std::string error;
+  if (!ensureSourceBytes(*handle_, &error)) {
+    Napi::Error::New(env, "Failed to read document: " + error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  const char* data = handle_->source.data;
+  size_t length = handle_->source.length;
+  
+  Napi::Value sharedArrayBuffer = env.Global().Get("SharedArrayBuffer");
+  if (!sharedArrayBuffer.IsFunction()) {
+    Napi::Error::New(env, "SharedArrayBuffer is not available").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  Napi::Object buffer = sharedArrayBuffer.As<Napi::Function>().New({ Napi::Number::New(env, static_cast<double>(length)) });
+  if (env.IsExceptionPending()) {
+    return env.Null();
+  }
+  Napi::Function uint8Array = env.Global().Get("Uint8Array").As<Napi::Function>();
+  Napi::Uint8Array view = uint8Array.New({ buffer }).As<Napi::Uint8Array>();
+  std::copy(data, data + length, reinterpret_cast<char*>(view.Data()));
+  CountCopiedToJs(length);
+  
+  sharedBuffer_ = Napi::Persistent(buffer);
+  return buffer;
+}
+
+Napi::Value Document::SetTileCacheSize(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  if (info.Length() < 1 || !info[0].IsNumber() || info[0].As<Napi::Number>().DoubleValue() < 0) {
+    Napi::TypeError::New(env, "Expected non-negative cache size in bytes").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  handle_->tiles.SetCapacity(static_cast<size_t>(info[0].As<Napi::Number>().DoubleValue()));
+  
+  return env.Undefined();
+}
+
+Napi::Value Document::GetTileCacheStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  const TileCache& tiles = handle_->tiles;
+  
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("hits", Napi::Number::New(env, static_cast<double>(tiles.Hits())));
+  stats.Set("misses", Napi::Number::New(env, static_cast<double>(tiles.Misses())));
+  stats.Set("size", Napi::Number::New(env, static_cast<double>(tiles.Size())));
+  stats.Set("bytes", Napi::Number::New(env, static_cast<double>(tiles.Bytes())));
+  stats.Set("capacity", Napi::Number::New(env, static_cast<double>(tiles.Capacity())));
+  
+  return stats;
+}
+
+Napi::Value Document::SetPageCacheSize(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  if (info.Length() < 1 || !info[0].IsNumber() || info[0].As<Napi::Number>().Int32Value() < 0) {
+    Napi::TypeError::New(env, "Expected non-negative cache size").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  handle_->pages.SetCapacity(info[0].As<Napi::Number>().Uint32Value());
+  
+  return env.Undefined();
+}
+
+Napi::Value Document::GetPageCacheStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("hits", Napi::Number::New(env, static_cast<double>(handle_->pages.Hits())));
+  stats.Set("misses", Napi::Number::New(env, static_cast<double>(handle_->pages.Misses())));
+  stats.Set("size", Napi::Number::New(env, handle_->pages.Size()));
+  stats.Set("capacity", Napi::Number::New(env, handle_->pages.Capacity()));
+  
+  return stats;
+}
+
+Napi::Value Document::SetRenderHints(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!handle_) {
+    Napi::Error::New(env, "Document not loaded").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected render hints object").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  Napi::Object hints = info[0].As<Napi::Object>();
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  poppler::page_renderer& renderer = handle_->renderer;
+  
+  if (hints.Has("antialiasing")) {
+    renderer.set_render_hint(poppler::page_renderer::antialiasing, hints.Get("antialiasing").ToBoolean());
+  }
+  
+  if (hints.Has("textAntialiasing")) {
+    renderer.set_render_hint(poppler::page_renderer::text_antialiasing, hints.Get("textAntialiasing").ToBoolean());
+  }
+  
+  if (hints.Has("textHinting")) {
+    renderer.set_render_hint(poppler::page_renderer::text_hinting, hints.Get("textHinting").ToBoolean());
+  }
+  
+  // Cached tiles were rendered with the old hints
+  handle_->tiles.Clear();
+  
+  return env.Undefined();
 }
\ No newline at end of file
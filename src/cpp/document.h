@@ -4,30 +4,58 @@
 
 #include <napi.h>
 #include <poppler/cpp/poppler-document.h>
+#include <cstdint>
 #include <memory>
+#include <vector>
+#include "document_handle.h"
 
 class Document : public Napi::ObjectWrap<Document> {
 public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
   Document(const Napi::CallbackInfo& info);
+  ~Document();
   
   // Static methods
   static Napi::Value LoadFromFile(const Napi::CallbackInfo& info);
   static Napi::Value LoadFromBuffer(const Napi::CallbackInfo& info);
+  static Napi::Value Probe(const Napi::CallbackInfo& info);
   
   // Instance methods
   Napi::Value GetPageCount(const Napi::CallbackInfo& info);
   Napi::Value GetPage(const Napi::CallbackInfo& info);
   Napi::Value GetMetadata(const Napi::CallbackInfo& info);
+  Napi::Value GetPageGeometries(const Napi::CallbackInfo& info);
   Napi::Value IsLocked(const Napi::CallbackInfo& info);
   Napi::Value Unlock(const Napi::CallbackInfo& info);
+  Napi::Value ExtractTextAsync(const Napi::CallbackInfo& info);
+  Napi::Value Pages(const Napi::CallbackInfo& info);
+  Napi::Value RenderPages(const Napi::CallbackInfo& info);
+  Napi::Value RenderTilesAsync(const Napi::CallbackInfo& info);
+  Napi::Value RenderThumbnails(const Napi::CallbackInfo& info);
+  Napi::Value BuildSearchIndex(const Napi::CallbackInfo& info);
+  Napi::Value SetExtractionCache(const Napi::CallbackInfo& info);
+  Napi::Value GetContentHash(const Napi::CallbackInfo& info);
+  Napi::Value GetSharedBuffer(const Napi::CallbackInfo& info);
+  Napi::Value SetTileCacheSize(const Napi::CallbackInfo& info);
+  Napi::Value GetTileCacheStats(const Napi::CallbackInfo& info);
+  Napi::Value SetPageCacheSize(const Napi::CallbackInfo& info);
+  Napi::Value GetPageCacheStats(const Napi::CallbackInfo& info);
+  Napi::Value SetRenderHints(const Napi::CallbackInfo& info);
+  Napi::Value Dispose(const Napi::CallbackInfo& info);
   
   // Getters
-  std::shared_ptr<poppler::document> GetDocument() const { return doc_; }
+  std::shared_ptr<DocumentHandle> GetHandle() const { return handle_; }
 
 private:
-  std::shared_ptr<poppler::document> doc_;
-  static Napi::FunctionReference constructor;
+  std::shared_ptr<DocumentHandle> handle_;
+  // Native memory reported to V8 on this Document's behalf
+  int64_t externalBytes_ = 0;
+  // SharedArrayBuffer holding the document's bytes: the one it was loaded
+  // from, or the copy made by getSharedBuffer()
+  Napi::ObjectReference sharedBuffer_;
+  // Packed values behind getPageGeometries(), computed on the first call
+  std::vector<double> geometries_;
+  bool geometriesReady_ = false;
 };
 
 #endif // DOCUMENT_H
\ No newline at end of file
@@ -0,0 +1,121 @@
+// src/cpp/document_handle.h
+#ifndef DOCUMENT_HANDLE_H
+#define DOCUMENT_HANDLE_H
+
+#include <poppler/cpp/poppler-document.h>
+#include <poppler/cpp/poppler-page-renderer.h>
+#include <climits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "extraction_cache.h"
+#include "page_cache.h"
+#include "stats.h"
+#include "tile_cache.h"
+
+// Where a document was loaded from, kept so worker threads can open their
+// own poppler::document: a single instance must never be shared between
+// threads.
+struct DocumentSource {
+  std::string path;      // set when loaded from a file
+  // The whole file in memory (a copied Buffer or a mapping), kept valid by
+  // `owner`; when set it is used instead of `path`
+  std::shared_ptr<const void> owner;
+  const char* data = nullptr;
+  size_t length = 0;
+  std::string password;  // last password that worked
+
+  // Opens a fresh, independent document. Returns nullptr on failure.
+  std::unique_ptr<poppler::document> Open() const {
+    StatsTimer timer(Stats::Global().load, "load");
+    poppler::document* doc = nullptr;
+    // poppler-cpp takes an int length, so larger inputs go through the path
+    if (data && length <= static_cast<size_t>(INT_MAX)) {
+      doc = poppler::document::load_from_raw_data(data, static_cast<int>(length), password, password);
+    } else if (!path.empty()) {
+      doc = poppler::document::load_from_file(path, password, password);
+    }
+    return std::unique_ptr<poppler::document>(doc);
+  }
+};
+
+// Parsed pages kept per document unless setPageCacheSize() says otherwise
+const size_t kDefaultPageCacheSize = 32;
+
+// Idle document copies kept for async single-page renders
+const size_t kMaxSpareDocuments = 4;
+
+// Native state shared by a Document, the Pages created from it and any
+// async work still in flight. poppler documents are not safe for concurrent
+// use, so every call into `doc`, one of its pages, `pages` or `renderer`
+// must hold `mutex`.
+struct DocumentHandle {
+  DocumentHandle(std::unique_ptr<poppler::document> document, DocumentSource documentSource)
+      : source(std::move(documentSource)), doc(std::move(document)), pages(kDefaultPageCacheSize) {
+    renderer.set_render_hint(poppler::page_renderer::antialiasing, true);
+    renderer.set_render_hint(poppler::page_renderer::text_antialiasing, true);
+    Stats::Global().liveDocuments.fetch_add(1, std::memory_order_relaxed);
+    Stats::Global().documentBytes.fetch_add(static_cast<int64_t>(source.length), std::memory_order_relaxed);
+  }
+  
+  ~DocumentHandle() {
+    Stats::Global().liveDocuments.fetch_sub(1, std::memory_order_relaxed);
+    Stats::Global().documentBytes.fetch_sub(static_cast<int64_t>(source.length), std::memory_order_relaxed);
+  }
+
+  // Declared before doc: poppler reads from memory sources lazily, so the
+  // bytes must outlive the document
+  DocumentSource source;
+  std::unique_ptr<poppler::document> doc;
+  // Declared after doc so cached pages are released first
+  PageCache pages;
+  
+  // Async renders of single pages use a private copy of the document, so a
+  // pool thread never holds `mutex` and never stalls the JS thread or other
+  // renders of this document. Copies are reused through a small free list.
+  // `from` is the source as read under `mutex` when the task was created.
+  std::unique_ptr<poppler::document> TakeSpare(const DocumentSource& from) {
+    {
+      std::lock_guard<std::mutex> lock(sparesMutex);
+      if (!spares.empty()) {
+        std::unique_ptr<poppler::document> spare = std::move(spares.back());
+        spares.pop_back();
+        return spare;
+      }
+    }
+    return from.Open();
+  }
+  
+  // Drops idle copies, e.g. once `source` points somewhere new
+  void ClearSpares() {
+    std::lock_guard<std::mutex> lock(sparesMutex);
+    spares.clear();
+  }
+  
+  void ReturnSpare(std::unique_ptr<poppler::document> spare) {
+    // A copy opened before unlock() succeeded is of no further use
+    if (!spare || spare->is_locked()) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(sparesMutex);
+    if (spares.size() < kMaxSpareDocuments) {
+      spares.push_back(std::move(spare));
+    }
+  }
+  
+  std::mutex sparesMutex;
+  std::vector<std::unique_ptr<poppler::document>> spares;
+  // Configured once and reused by every render of this document
+  poppler::page_renderer renderer;
+  std::mutex mutex;
+  // Set by setExtractionCache(); pages look up and store their extraction
+  // results under `contentKey`, the hash of the document's bytes
+  std::shared_ptr<const ExtractionCache> extraction;
+  std::string contentKey;
+  // Rendered tiles from renderTilesAsync(); locks itself rather than `mutex`
+  // because tile batches consult it from worker threads
+  TileCache tiles;
+};
+
+#endif // DOCUMENT_HANDLE_H
@@ -0,0 +1,320 @@
+// src/cpp/encode.cpp
+#include "encode.h"
+#include <csetjmp>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <png.h>
+extern "C" {
+#include <jpeglib.h>
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POPPLER_ENCODE_SSE2 1
+#elif defined(__ARM_NEON) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_neon.h>
+#define POPPLER_ENCODE_NEON 1
+#endif
+
+namespace {
+
+// poppler's ARGB32 pixels are native-endian 0xAARRGGBB words, so the
+// scalar path reads whole words and never depends on byte order
+inline uint32_t loadPixel(const char* src) {
+  uint32_t pixel;
+  std::memcpy(&pixel, src, sizeof(pixel));
+  return pixel;
+}
+
+// ITU-R BT.601 luma in 8.8 fixed point; the weights sum to 256
+inline uint8_t luma(uint32_t r, uint32_t g, uint32_t b) {
+  return static_cast<uint8_t>((r * 77 + g * 150 + b * 29) >> 8);
+}
+
+void convertRow(const char* src, char* dst, int width, ImageEncoding encoding) {
+  int x = 0;
+  uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+
+#if defined(POPPLER_ENCODE_SSE2)
+  // In memory each pixel is B, G, R, A
+  if (encoding == ImageEncoding::RGBA) {
+    const __m128i agMask = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+    const __m128i rbMask = _mm_set1_epi32(0x00FF00FF);
+    for (; x + 4 <= width; x += 4) {
+      __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+      __m128i rb = _mm_and_si128(px, rbMask);
+      rb = _mm_or_si128(_mm_srli_epi32(rb, 16), _mm_slli_epi32(rb, 16));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4),
+                       _mm_or_si128(_mm_and_si128(px, agMask), rb));
+    }
+  } else if (encoding == ImageEncoding::Gray) {
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const __m128i wr = _mm_set1_epi32(77);
+    const __m128i wg = _mm_set1_epi32(150);
+    const __m128i wb = _mm_set1_epi32(29);
+    auto luma4 = [&](const char* p) {
+      __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      __m128i b = _mm_and_si128(px, byteMask);
+      __m128i g = _mm_and_si128(_mm_srli_epi32(px, 8), byteMask);
+      __m128i r = _mm_and_si128(_mm_srli_epi32(px, 16), byteMask);
+      // Products and their sum fit in the low 16 bits of each lane
+      __m128i sum = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi16(r, wr), _mm_mullo_epi16(g, wg)),
+                                  _mm_mullo_epi16(b, wb));
+      return _mm_srli_epi32(sum, 8);
+    };
+    for (; x + 16 <= width; x += 16) {
+      const char* p = src + x * 4;
+      __m128i lo = _mm_packs_epi32(luma4(p), luma4(p + 16));
+      __m128i hi = _mm_packs_epi32(luma4(p + 32), luma4(p + 48));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(lo, hi));
+    }
+  }
+#elif defined(POPPLER_ENCODE_NEON)
+  // vld4 splits 16 pixels into B, G, R and A planes
+  for (; x + 16 <= width; x += 16) {
+    uint8x16x4_t px = vld4q_u8(reinterpret_cast<const uint8_t*>(src + x * 4));
+    if (encoding == ImageEncoding::RGBA) {
+      uint8x16x4_t rgba = {{ px.val[2], px.val[1], px.val[0], px.val[3] }};
+      vst4q_u8(out + x * 4, rgba);
+    } else if (encoding == ImageEncoding::RGB) {
+      uint8x16x3_t rgb = {{ px.val[2], px.val[1], px.val[0] }};
+      vst3q_u8(out + x * 3, rgb);
+    } else {
+      uint16x8_t lo = vmull_u8(vget_low_u8(px.val[2]), vdup_n_u8(77));
+      lo = vmlal_u8(lo, vget_low_u8(px.val[1]), vdup_n_u8(150));
+      lo = vmlal_u8(lo, vget_low_u8(px.val[0]), vdup_n_u8(29));
+      uint16x8_t hi = vmull_u8(vget_high_u8(px.val[2]), vdup_n_u8(77));
+      hi = vmlal_u8(hi, vget_high_u8(px.val[1]), vdup_n_u8(150));
+      hi = vmlal_u8(hi, vget_high_u8(px.val[0]), vdup_n_u8(29));
+      vst1q_u8(out + x, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+  }
+#endif
+
+  // Scalar tail (and the whole row where no SIMD path applies)
+  for (; x < width; ++x) {
+    uint32_t pixel = loadPixel(src + x * 4);
+    uint32_t a = pixel >> 24;
+    uint32_t r = (pixel >> 16) & 0xFF;
+    uint32_t g = (pixel >> 8) & 0xFF;
+    uint32_t b = pixel & 0xFF;
+    switch (encoding) {
+      case ImageEncoding::RGBA:
+        out[x * 4] = static_cast<uint8_t>(r);
+        out[x * 4 + 1] = static_cast<uint8_t>(g);
+        out[x * 4 + 2] = static_cast<uint8_t>(b);
+        out[x * 4 + 3] = static_cast<uint8_t>(a);
+        break;
+      case ImageEncoding::RGB:
+        out[x * 3] = static_cast<uint8_t>(r);
+        out[x * 3 + 1] = static_cast<uint8_t>(g);
+        out[x * 3 + 2] = static_cast<uint8_t>(b);
+        break;
+      case ImageEncoding::Gray:
+        out[x] = luma(r, g, b);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+// Feeds an image to an encoder one tightly packed row at a time. ARGB32
+// rows are converted to RGBA (or RGB without alpha); rgb24 and gray8 rows
+// are passed through as they are.
+class PackedRows {
+public:
+  PackedRows(const poppler::image& image, bool alpha) : image_(image) {
+    switch (image.format()) {
+      case poppler::image::format_argb32:
+        encoding_ = alpha ? ImageEncoding::RGBA : ImageEncoding::RGB;
+        break;
+      case poppler::image::format_rgb24:
+        encoding_ = ImageEncoding::RGB;
+        break;
+      case poppler::image::format_gray8:
+        encoding_ = ImageEncoding::Gray;
+        break;
+      default:
+        throw std::runtime_error("Unsupported bitmap format for encoding");
+    }
+    if (image.format() == poppler::image::format_argb32) {
+      row_.resize(static_cast<size_t>(image.width()) * Channels());
+    }
+  }
+  
+  int Channels() const { return ImageEncodingBytesPerPixel(encoding_); }
+  
+  unsigned char* Row(int y) {
+    const char* src = image_.const_data() + static_cast<size_t>(y) * image_.bytes_per_row();
+    if (row_.empty()) {
+      return reinterpret_cast<unsigned char*>(const_cast<char*>(src));
+    }
+    convertRow(src, row_.data(), image_.width(), encoding_);
+    return reinterpret_cast<unsigned char*>(row_.data());
+  }
+
+private:
+  const poppler::image& image_;
+  ImageEncoding encoding_;
+  std::vector<char> row_;
+};
+
+// The encoders report errors by longjmp; anything they write to after
+// setjmp lives on the heap so it is still valid when they do
+std::vector<char> encodePng(const poppler::image& image) {
+  PackedRows rows(image, true);
+  auto out = std::make_unique<std::vector<char>>();
+  
+  png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+  png_infop info = png ? png_create_info_struct(png) : nullptr;
+  if (!info) {
+    png_destroy_write_struct(&png, nullptr);
+    throw std::runtime_error("Failed to create PNG encoder");
+  }
+  if (setjmp(png_jmpbuf(png))) {
+    png_destroy_write_struct(&png, &info);
+    throw std::runtime_error("Failed to encode image as png");
+  }
+  
+  png_set_write_fn(png, out.get(), [](png_structp writer, png_bytep data, png_size_t length) {
+    auto* bytes = static_cast<std::vector<char>*>(png_get_io_ptr(writer));
+    // png_error longjmps, which must not leave an active catch handler
+    bool failed = false;
+    try {
+      bytes->insert(bytes->end(), data, data + length);
+    } catch (const std::bad_alloc&) {
+      failed = true;
+    }
+    if (failed) {
+      png_error(writer, "out of memory");
+    }
+  }, nullptr);
+  
+  int colorType = rows.Channels() == 4 ? PNG_COLOR_TYPE_RGB_ALPHA
+                  : rows.Channels() == 3 ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_GRAY;
+  png_set_IHDR(png, info, image.width(), image.height(), 8, colorType, PNG_INTERLACE_NONE,
+               PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png, info);
+  for (int y = 0; y < image.height(); ++y) {
+    png_write_row(png, rows.Row(y));
+  }
+  png_write_end(png, nullptr);
+  png_destroy_write_struct(&png, &info);
+  
+  return std::move(*out);
+}
+
+struct JpegErrors {
+  jpeg_error_mgr manager; // first, so libjpeg's pointer to it is ours too
+  std::jmp_buf jump;
+};
+
+// libjpeg allocates the output with malloc
+struct JpegOutput {
+  unsigned char* data = nullptr;
+  unsigned long size = 0;
+  ~JpegOutput() { std::free(data); }
+};
+
+std::vector<char> encodeJpeg(const poppler::image& image) {
+  PackedRows rows(image, false);
+  auto errors = std::make_unique<JpegErrors>();
+  auto out = std::make_unique<JpegOutput>();
+  auto cinfo = std::make_unique<jpeg_compress_struct>();
+  
+  cinfo->err = jpeg_std_error(&errors->manager);
+  errors->manager.error_exit = [](j_common_ptr common) {
+    std::longjmp(reinterpret_cast<JpegErrors*>(common->err)->jump, 1);
+  };
+  if (setjmp(errors->jump)) {
+    jpeg_destroy_compress(cinfo.get());
+    throw std::runtime_error("Failed to encode image as jpeg");
+  }
+  
+  jpeg_create_compress(cinfo.get());
+  jpeg_mem_dest(cinfo.get(), &out->data, &out->size);
+  cinfo->image_width = static_cast<JDIMENSION>(image.width());
+  cinfo->image_height = static_cast<JDIMENSION>(image.height());
+  cinfo->input_components = rows.Channels();
+  cinfo->in_color_space = rows.Channels() == 1 ? JCS_GRAYSCALE : JCS_RGB;
+  jpeg_set_defaults(cinfo.get());
+  jpeg_start_compress(cinfo.get(), TRUE);
+  while (cinfo->next_scanline < cinfo->image_height) {
+    JSAMPROW row = rows.Row(static_cast<int>(cinfo->next_scanline));
+    jpeg_write_scanlines(cinfo.get(), &row, 1);
+  }
+  jpeg_finish_compress(cinfo.get());
+  jpeg_destroy_compress(cinfo.get());
+  
+  return std::vector<char>(out->data, out->data + out->size);
+}
+
+} // namespace
+
+bool ParseImageEncoding(const std::string& name, ImageEncoding* encoding) {
+  if (name == "argb32") *encoding = ImageEncoding::ARGB32;
+  else if (name == "rgba") *encoding = ImageEncoding::RGBA;
+  else if (name == "rgb") *encoding = ImageEncoding::RGB;
+  else if (name == "gray") *encoding = ImageEncoding::Gray;
+  else if (name == "png") *encoding = ImageEncoding::PNG;
+  else if (name == "jpeg") *encoding = ImageEncoding::JPEG;
+  else return false;
+  return true;
+}
+
+const char* ImageEncodingFormat(ImageEncoding encoding) {
+  switch (encoding) {
+    case ImageEncoding::RGBA: return "RGBA";
+    case ImageEncoding::RGB: return "RGB";
+    case ImageEncoding::Gray: return "GRAY8";
+    case ImageEncoding::PNG: return "PNG";
+    case ImageEncoding::JPEG: return "JPEG";
+    default: return "ARGB32";
+  }
+}
+
+int ImageEncodingBytesPerPixel(ImageEncoding encoding) {
+  switch (encoding) {
+    case ImageEncoding::ARGB32:
+    case ImageEncoding::RGBA: return 4;
+    case ImageEncoding::RGB: return 3;
+    case ImageEncoding::Gray: return 1;
+    default: return 0;
+  }
+}
+
+poppler::image::format_enum ImageEncodingRenderFormat(ImageEncoding encoding) {
+  switch (encoding) {
+    case ImageEncoding::RGB: return poppler::image::format_rgb24;
+    case ImageEncoding::Gray: return poppler::image::format_gray8;
+    default: return poppler::image::format_argb32;
+  }
+}
+
+void ConvertPixels(const poppler::image& image, ImageEncoding encoding, char* dst) {
+  const char* src = image.const_data();
+  int width = image.width();
+  size_t dstRow = static_cast<size_t>(width) * ImageEncodingBytesPerPixel(encoding);
+  
+  if (image.format() != poppler::image::format_argb32) {
+    // Rendered in the target format; rows only need their padding removed
+    for (int y = 0; y < image.height(); ++y) {
+      std::memcpy(dst + y * dstRow, src + static_cast<size_t>(y) * image.bytes_per_row(), dstRow);
+    }
+    return;
+  }
+  
+  for (int y = 0; y < image.height(); ++y) {
+    convertRow(src + static_cast<size_t>(y) * image.bytes_per_row(), dst + y * dstRow, width, encoding);
+  }
+}
+
+std::vector<char> CompressImage(const poppler::image& image, ImageEncoding encoding) {
+  return encoding == ImageEncoding::PNG ? encodePng(image) : encodeJpeg(image);
+}
@@ -0,0 +1,42 @@
+// src/cpp/encode.h
+#ifndef ENCODE_H
+#define ENCODE_H
+
+#include <poppler/cpp/poppler-image.h>
+#include <string>
+#include <vector>
+
+// Output encodings for rendered pages. ARGB32 is poppler's native bitmap.
+enum class ImageEncoding {
+  ARGB32,
+  RGBA,
+  RGB,
+  Gray,
+  PNG,
+  JPEG
+};
+
+// Maps a JS encoding name ('argb32', 'rgba', 'rgb', 'gray', 'png', 'jpeg')
+bool ParseImageEncoding(const std::string& name, ImageEncoding* encoding);
+
+// Value reported as `format` on the JS side, e.g. "RGBA" or "PNG"
+const char* ImageEncodingFormat(ImageEncoding encoding);
+
+// Bytes per pixel of the raw encodings, 0 for compressed ones
+int ImageEncodingBytesPerPixel(ImageEncoding encoding);
+
+// The bitmap format poppler can render straight into for this encoding:
+// argb32, rgb24 or gray8. Everything else renders as argb32.
+poppler::image::format_enum ImageEncodingRenderFormat(ImageEncoding encoding);
+
+// Converts an image into a tightly packed raw encoding. The image is either
+// ARGB32 or already in ImageEncodingRenderFormat(encoding), in which case
+// only row padding is dropped. `dst` must hold
+// width * height * ImageEncodingBytesPerPixel(encoding) bytes.
+void ConvertPixels(const poppler::image& image, ImageEncoding encoding, char* dst);
+
+// Compresses in memory with libpng or libjpeg. Throws std::runtime_error
+// if encoding fails.
+std::vector<char> CompressImage(const poppler::image& image, ImageEncoding encoding);
+
+#endif // ENCODE_H
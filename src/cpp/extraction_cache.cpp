@@ -0,0 +1,247 @@
+// src/cpp/extraction_cache.cpp
+#include "extraction_cache.h"
+#include "mapped_file.h"
+#include "stats.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace {
+
+const char kMagic[4] = { 'P', 'X', 'C', 'R' };
+// Bump whenever the record layout or the extraction behind it changes
+const uint32_t kVersion = 1;
+const uint32_t kByteOrderMark = 0x01020304;
+
+template <typename T>
+void append(std::vector<char>& out, const T* values, size_t count) {
+  const char* bytes = reinterpret_cast<const char*>(values);
+  out.insert(out.end(), bytes, bytes + count * sizeof(T));
+}
+
+std::string toUtf8(const poppler::ustring& text) {
+  poppler::byte_array utf8_bytes = text.to_utf8();
+  return std::string(utf8_bytes.data(), utf8_bytes.size());
+}
+
+} // namespace
+
+std::vector<char> PageRecord::Build(const poppler::page& page) {
+  std::string text;
+  std::vector<poppler::text_box> textBoxes;
+  {
+    StatsTimer timer(Stats::Global().textExtract, "textExtract");
+    text = toUtf8(page.text());
+    textBoxes = page.text_list();
+  }
+  poppler::rectf rect = page.page_rect();
+  
+  std::vector<LayoutBox> boxes;
+  std::vector<double> wordBoxes;
+  std::vector<int32_t> wordRotations;
+  std::vector<uint32_t> wordOffsets;
+  std::string wordText;
+  boxes.reserve(textBoxes.size());
+  wordBoxes.reserve(textBoxes.size() * 4);
+  wordRotations.reserve(textBoxes.size());
+  wordOffsets.reserve(textBoxes.size() + 1);
+  
+  for (const auto& box : textBoxes) {
+    poppler::rectf bbox = box.bbox();
+    boxes.push_back({ bbox.x(), bbox.y(), bbox.width(), bbox.height(), box.rotation() });
+    wordBoxes.insert(wordBoxes.end(), { bbox.x(), bbox.y(), bbox.width(), bbox.height() });
+    wordRotations.push_back(box.rotation());
+    wordOffsets.push_back(static_cast<uint32_t>(wordText.size()));
+    wordText += toUtf8(box.text());
+  }
+  wordOffsets.push_back(static_cast<uint32_t>(wordText.size()));
+  
+  std::vector<LayoutLine> lines = BuildLines(boxes, LayoutOptions());
+  std::vector<double> lineBoxes;
+  std::vector<int32_t> lineRotations;
+  std::vector<uint32_t> lineStarts;
+  std::vector<uint32_t> lineWords;
+  lineBoxes.reserve(lines.size() * 4);
+  lineRotations.reserve(lines.size());
+  lineStarts.reserve(lines.size() + 1);
+  lineWords.reserve(textBoxes.size());
+  
+  for (const LayoutLine& line : lines) {
+    lineBoxes.insert(lineBoxes.end(), { line.x0, line.y0, line.x1, line.y1 });
+    lineRotations.push_back(line.rotation);
+    lineStarts.push_back(static_cast<uint32_t>(lineWords.size()));
+    for (size_t box : line.boxes) {
+      lineWords.push_back(static_cast<uint32_t>(box));
+    }
+  }
+  lineStarts.push_back(static_cast<uint32_t>(lineWords.size()));
+  
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.byteOrder = kByteOrderMark;
+  header.rotation = static_cast<int32_t>(page.orientation());
+  header.width = rect.width();
+  header.height = rect.height();
+  header.wordCount = static_cast<uint32_t>(textBoxes.size());
+  header.lineCount = static_cast<uint32_t>(lines.size());
+  header.lineWordCount = static_cast<uint32_t>(lineWords.size());
+  header.textLength = static_cast<uint32_t>(text.size());
+  header.wordTextLength = static_cast<uint32_t>(wordText.size());
+  
+  std::vector<char> out;
+  out.reserve(sizeof(Header) + (wordBoxes.size() + lineBoxes.size()) * sizeof(double) +
+              (wordRotations.size() + lineRotations.size() + wordOffsets.size() +
+               lineStarts.size() + lineWords.size()) * sizeof(uint32_t) +
+              text.size() + wordText.size());
+  append(out, &header, 1);
+  append(out, wordBoxes.data(), wordBoxes.size());
+  append(out, lineBoxes.data(), lineBoxes.size());
+  append(out, wordRotations.data(), wordRotations.size());
+  append(out, lineRotations.data(), lineRotations.size());
+  append(out, wordOffsets.data(), wordOffsets.size());
+  append(out, lineStarts.data(), lineStarts.size());
+  append(out, lineWords.data(), lineWords.size());
+  append(out, text.data(), text.size());
+  append(out, wordText.data(), wordText.size());
+  return out;
+}
+
+std::shared_ptr<const PageRecord> PageRecord::Parse(std::shared_ptr<const void> owner, const char* data,
+                                                    size_t length) {
+  std::shared_ptr<PageRecord> record(new PageRecord());
+  if (length < sizeof(Header)) {
+    return nullptr;
+  }
+  
+  Header& header = record->header_;
+  std::memcpy(&header, data, sizeof(Header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.byteOrder != kByteOrderMark) {
+    return nullptr;
+  }
+  
+  size_t words = header.wordCount;
+  size_t lines = header.lineCount;
+  size_t expected = sizeof(Header) + (words + lines) * 4 * sizeof(double) +
+                    (words + lines + (words + 1) + (lines + 1) + header.lineWordCount) * sizeof(uint32_t) +
+                    header.textLength + header.wordTextLength;
+  if (length != expected) {
+    return nullptr;
+  }
+  
+  // The header is a multiple of 8 bytes and the doubles come first, so
+  // every array is naturally aligned within the (page-aligned) mapping
+  const char* p = data + sizeof(Header);
+  record->wordBoxes_ = reinterpret_cast<const double*>(p);
+  p += words * 4 * sizeof(double);
+  record->lineBoxes_ = reinterpret_cast<const double*>(p);
+  p += lines * 4 * sizeof(double);
+  record->wordRotations_ = reinterpret_cast<const int32_t*>(p);
+  p += words * sizeof(int32_t);
+  record->lineRotations_ = reinterpret_cast<const int32_t*>(p);
+  p += lines * sizeof(int32_t);
+  record->wordOffsets_ = reinterpret_cast<const uint32_t*>(p);
+  p += (words + 1) * sizeof(uint32_t);
+  record->lineStarts_ = reinterpret_cast<const uint32_t*>(p);
+  p += (lines + 1) * sizeof(uint32_t);
+  record->lineWords_ = reinterpret_cast<const uint32_t*>(p);
+  p += header.lineWordCount * sizeof(uint32_t);
+  record->text_ = p;
+  p += header.textLength;
+  record->wordText_ = p;
+  
+  // Offsets and indices must stay inside the record
+  for (size_t i = 0; i < words; ++i) {
+    if (record->wordOffsets_[i] > record->wordOffsets_[i + 1]) {
+      return nullptr;
+    }
+  }
+  if (record->wordOffsets_[words] > header.wordTextLength) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < lines; ++i) {
+    if (record->lineStarts_[i] > record->lineStarts_[i + 1]) {
+      return nullptr;
+    }
+  }
+  if (record->lineStarts_[lines] > header.lineWordCount) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < header.lineWordCount; ++i) {
+    if (record->lineWords_[i] >= words) {
+      return nullptr;
+    }
+  }
+  
+  record->owner_ = std::move(owner);
+  return record;
+}
+
+std::string_view PageRecord::WordText(size_t index) const {
+  return std::string_view(wordText_ + wordOffsets_[index], wordOffsets_[index + 1] - wordOffsets_[index]);
+}
+
+LayoutBox PageRecord::WordBox(size_t index) const {
+  const double* box = wordBoxes_ + index * 4;
+  return { box[0], box[1], box[2], box[3], wordRotations_[index] };
+}
+
+std::vector<LayoutLine> PageRecord::Lines() const {
+  std::vector<LayoutLine> lines(header_.lineCount);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    LayoutLine& line = lines[i];
+    line.boxes.assign(lineWords_ + lineStarts_[i], lineWords_ + lineStarts_[i + 1]);
+    line.x0 = lineBoxes_[i * 4];
+    line.y0 = lineBoxes_[i * 4 + 1];
+    line.x1 = lineBoxes_[i * 4 + 2];
+    line.y1 = lineBoxes_[i * 4 + 3];
+    line.rotation = lineRotations_[i];
+  }
+  return lines;
+}
+
+std::string ExtractionCache::PathFor(const std::string& documentKey, int page) const {
+  return (std::filesystem::path(directory_) / (documentKey + "." + std::to_string(page) + ".pxc")).string();
+}
+
+std::shared_ptr<const PageRecord> ExtractionCache::Load(const std::string& documentKey, int page) const {
+  std::string error;
+  std::shared_ptr<MappedFile> mapping = MappedFile::Open(PathFor(documentKey, page), &error);
+  if (!mapping) {
+    return nullptr;
+  }
+  return PageRecord::Parse(mapping, mapping->Data(), mapping->Length());
+}
+
+void ExtractionCache::Store(const std::string& documentKey, int page, const std::vector<char>& record) const {
+  static std::atomic<unsigned long> counter{0};
+  static const unsigned int salt = std::random_device()();
+  
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  
+  std::string path = PathFor(documentKey, page);
+  auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+  std::string temp = path + "." + std::to_string(salt) + "-" + std::to_string(ticks) + "-" +
+                     std::to_string(counter++) + ".tmp";
+  
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    out.write(record.data(), static_cast<std::streamsize>(record.size()));
+    if (!out) {
+      out.close();
+      std::filesystem::remove(temp, error);
+      return;
+    }
+  }
+  
+  std::filesystem::rename(temp, path, error);
+  if (error) {
+    std::filesystem::remove(temp, error);
+  }
+}
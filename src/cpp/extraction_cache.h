@@ -0,0 +1,91 @@
+// src/cpp/extraction_cache.h
+#ifndef EXTRACTION_CACHE_H
+#define EXTRACTION_CACHE_H
+
+#include <poppler/cpp/poppler-page.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "layout.h"
+
+// Read-only view of one page's extraction results in their binary form:
+// the page text, every word with its box, and the lines BuildLines() makes
+// with default options. The bytes come from a mapped cache file or from a
+// freshly built blob; `owner` keeps them alive.
+class PageRecord {
+public:
+  // Extracts `page` and serializes the results. Caller must hold the
+  // owning document's mutex.
+  static std::vector<char> Build(const poppler::page& page);
+
+  // Returns nullptr if the bytes are truncated or from another format version
+  static std::shared_ptr<const PageRecord> Parse(std::shared_ptr<const void> owner, const char* data,
+                                                 size_t length);
+
+  double Width() const { return header_.width; }
+  double Height() const { return header_.height; }
+  int Rotation() const { return header_.rotation; }
+  std::string_view Text() const { return std::string_view(text_, header_.textLength); }
+
+  size_t WordCount() const { return header_.wordCount; }
+  std::string_view WordText(size_t index) const;
+  LayoutBox WordBox(size_t index) const;
+
+  std::vector<LayoutLine> Lines() const;
+
+private:
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    int32_t rotation;
+    double width;
+    double height;
+    uint32_t wordCount;
+    uint32_t lineCount;
+    uint32_t lineWordCount;
+    uint32_t textLength;
+    uint32_t wordTextLength;
+    uint32_t reserved;
+  };
+
+  PageRecord() = default;
+
+  std::shared_ptr<const void> owner_;
+  Header header_;
+  // Arrays following the header, widest elements first so all stay aligned
+  const double* wordBoxes_;     // x, y, width, height per word
+  const double* lineBoxes_;     // x0, y0, x1, y1 per line
+  const int32_t* wordRotations_;
+  const int32_t* lineRotations_;
+  const uint32_t* wordOffsets_; // wordCount + 1 offsets into wordText_
+  const uint32_t* lineStarts_;  // lineCount + 1 offsets into lineWords_
+  const uint32_t* lineWords_;
+  const char* text_;
+  const char* wordText_;
+};
+
+// Directory of PageRecords named after the document's content hash and the
+// page index, shared by every process pointed at it. Reads map the file;
+// writes go to a temporary file that is renamed into place, so readers
+// never see a partial record. Failures to read or write are treated as
+// misses: the cache never makes extraction fail.
+class ExtractionCache {
+public:
+  explicit ExtractionCache(std::string directory) : directory_(std::move(directory)) {}
+
+  std::shared_ptr<const PageRecord> Load(const std::string& documentKey, int page) const;
+  void Store(const std::string& documentKey, int page, const std::vector<char>& record) const;
+
+  const std::string& Directory() const { return directory_; }
+
+private:
+  std::string PathFor(const std::string& documentKey, int page) const;
+
+  std::string directory_;
+};
+
+#endif // EXTRACTION_CACHE_H
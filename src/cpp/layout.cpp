@@ -0,0 +1,229 @@
+// src/cpp/layout.cpp
+#include "layout.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+// A box seen in its own text direction: `along` runs with the baseline and
+// `across` perpendicular to it, so rotated text is grouped the same way
+struct Oriented {
+  double along;    // reading-order position
+  double across;   // centre across the baseline
+  double start;    // extent along the baseline
+  double end;
+  double thickness; // font height
+};
+
+Oriented orient(const LayoutBox& box) {
+  switch (box.rotation & 3) {
+    case 1: // reads top to bottom
+      return { box.y, box.x + box.width / 2, box.y, box.y + box.height, box.width };
+    case 2: // upside down, reads right to left
+      return { -(box.x + box.width), box.y + box.height / 2, -(box.x + box.width), -box.x, box.height };
+    case 3: // reads bottom to top
+      return { -(box.y + box.height), box.x + box.width / 2, -(box.y + box.height), -box.y, box.width };
+    default:
+      return { box.x, box.y + box.height / 2, box.x, box.x + box.width, box.height };
+  }
+}
+
+void extend(LayoutLine& line, const LayoutBox& box) {
+  line.x0 = std::min(line.x0, box.x);
+  line.y0 = std::min(line.y0, box.y);
+  line.x1 = std::max(line.x1, box.x + box.width);
+  line.y1 = std::max(line.y1, box.y + box.height);
+}
+
+LayoutLine startLine(size_t index, const LayoutBox& box) {
+  LayoutLine line;
+  line.boxes.push_back(index);
+  line.x0 = box.x;
+  line.y0 = box.y;
+  line.x1 = box.x + box.width;
+  line.y1 = box.y + box.height;
+  line.rotation = box.rotation & 3;
+  return line;
+}
+
+// Appends `group` (indices into `blocks`) to `order` in reading order.
+// Tries cutting across y first, then across x; each band is cut again on
+// the other axis.
+void xyCut(const std::vector<LayoutBlock>& blocks, std::vector<size_t> group, bool horizontalFirst,
+           std::vector<size_t>& order) {
+  if (group.size() <= 1) {
+    order.insert(order.end(), group.begin(), group.end());
+    return;
+  }
+  
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    bool horizontal = (attempt == 0) == horizontalFirst;
+    auto start = [&](size_t i) { return horizontal ? blocks[i].y0 : blocks[i].x0; };
+    auto end = [&](size_t i) { return horizontal ? blocks[i].y1 : blocks[i].x1; };
+    std::sort(group.begin(), group.end(), [&](size_t a, size_t b) {
+      if (start(a) != start(b)) return start(a) < start(b);
+      return a < b;
+    });
+    
+    // Split wherever a block starts past everything before it
+    std::vector<std::vector<size_t>> bands(1);
+    double reach = end(group[0]);
+    bands.back().push_back(group[0]);
+    for (size_t i = 1; i < group.size(); ++i) {
+      if (start(group[i]) >= reach) {
+        bands.emplace_back();
+      }
+      bands.back().push_back(group[i]);
+      reach = std::max(reach, end(group[i]));
+    }
+    
+    if (bands.size() > 1) {
+      for (std::vector<size_t>& band : bands) {
+        xyCut(blocks, std::move(band), !horizontal, order);
+      }
+      return;
+    }
+  }
+  
+  // Overlapping in both directions: fall back to top to bottom
+  std::sort(group.begin(), group.end(), [&](size_t a, size_t b) {
+    if (blocks[a].y0 != blocks[b].y0) return blocks[a].y0 < blocks[b].y0;
+    if (blocks[a].x0 != blocks[b].x0) return blocks[a].x0 < blocks[b].x0;
+    return a < b;
+  });
+  order.insert(order.end(), group.begin(), group.end());
+}
+
+} // namespace
+
+std::vector<LayoutLine> BuildLines(const std::vector<LayoutBox>& boxes, const LayoutOptions& options) {
+  std::vector<Oriented> oriented;
+  oriented.reserve(boxes.size());
+  for (const LayoutBox& box : boxes) {
+    oriented.push_back(orient(box));
+  }
+  
+  // Sort by rotation, then across the baseline, then along it; ties fall
+  // back to input position so equal inputs always give equal output
+  std::vector<size_t> order(boxes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    int ra = boxes[a].rotation & 3, rb = boxes[b].rotation & 3;
+    if (ra != rb) return ra < rb;
+    if (oriented[a].across != oriented[b].across) return oriented[a].across < oriented[b].across;
+    if (oriented[a].along != oriented[b].along) return oriented[a].along < oriented[b].along;
+    return a < b;
+  });
+  
+  // Single sweep: a box either joins the line being built or starts the
+  // next one. The line's first box anchors it so long lines cannot drift.
+  std::vector<LayoutLine> rawLines;
+  double anchor = 0, thickness = 0;
+  for (size_t index : order) {
+    const Oriented& o = oriented[index];
+    if (!rawLines.empty() && rawLines.back().rotation == (boxes[index].rotation & 3)) {
+      double tolerance = options.lineTolerance * std::min(thickness, o.thickness);
+      if (o.across - anchor <= tolerance) {
+        rawLines.back().boxes.push_back(index);
+        extend(rawLines.back(), boxes[index]);
+        thickness = std::max(thickness, o.thickness);
+        continue;
+      }
+    }
+    rawLines.push_back(startLine(index, boxes[index]));
+    anchor = o.across;
+    thickness = o.thickness;
+  }
+  
+  // Order words along the baseline, splitting at column gaps if requested
+  std::vector<LayoutLine> lines;
+  lines.reserve(rawLines.size());
+  for (LayoutLine& raw : rawLines) {
+    std::sort(raw.boxes.begin(), raw.boxes.end(), [&](size_t a, size_t b) {
+      if (oriented[a].along != oriented[b].along) return oriented[a].along < oriented[b].along;
+      return a < b;
+    });
+    
+    if (options.columnGap <= 0) {
+      lines.push_back(std::move(raw));
+      continue;
+    }
+    
+    LayoutLine current = startLine(raw.boxes[0], boxes[raw.boxes[0]]);
+    for (size_t i = 1; i < raw.boxes.size(); ++i) {
+      size_t prev = raw.boxes[i - 1], index = raw.boxes[i];
+      double gap = oriented[index].start - oriented[prev].end;
+      double height = std::max(oriented[prev].thickness, oriented[index].thickness);
+      if (gap > options.columnGap * height) {
+        lines.push_back(std::move(current));
+        current = startLine(index, boxes[index]);
+      } else {
+        current.boxes.push_back(index);
+        extend(current, boxes[index]);
+      }
+    }
+    lines.push_back(std::move(current));
+  }
+  
+  return lines;
+}
+
+std::vector<LayoutBlock> BuildBlocks(const std::vector<LayoutLine>& lines, const LayoutOptions& options) {
+  std::vector<LayoutBlock> blocks;
+  // Blocks that may still grow, with the rotation and font height of their
+  // last line; lines arrive top to bottom, so blocks whose bottom is too
+  // far above the current line are closed for good
+  struct Open { size_t block; int rotation; double height; };
+  std::vector<Open> open;
+  
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const LayoutLine& line = lines[i];
+    bool vertical = line.rotation == 1 || line.rotation == 3;
+    double height = vertical ? line.x1 - line.x0 : line.y1 - line.y0;
+    
+    LayoutBlock* target = nullptr;
+    for (size_t j = 0; j < open.size();) {
+      LayoutBlock& block = blocks[open[j].block];
+      double gap = vertical ? line.x0 - block.x1 : line.y0 - block.y1;
+      double limit = options.blockGap * std::max(height, open[j].height);
+      if (open[j].rotation != line.rotation || gap > limit) {
+        if (open[j].rotation == line.rotation) {
+          // Lines only move further down, so this block is finished
+          open.erase(open.begin() + j);
+          continue;
+        }
+        ++j;
+        continue;
+      }
+      bool overlaps = vertical ? line.y0 < block.y1 && block.y0 < line.y1
+                               : line.x0 < block.x1 && block.x0 < line.x1;
+      if (!target && overlaps) {
+        target = &block;
+        open[j].height = height;
+      }
+      ++j;
+    }
+    
+    if (target) {
+      target->lines.push_back(i);
+      target->x0 = std::min(target->x0, line.x0);
+      target->y0 = std::min(target->y0, line.y0);
+      target->x1 = std::max(target->x1, line.x1);
+      target->y1 = std::max(target->y1, line.y1);
+    } else {
+      blocks.push_back({ { i }, line.x0, line.y0, line.x1, line.y1 });
+      open.push_back({ blocks.size() - 1, line.rotation, height });
+    }
+  }
+  
+  return blocks;
+}
+
+std::vector<size_t> ReadingOrder(const std::vector<LayoutBlock>& blocks) {
+  std::vector<size_t> group(blocks.size());
+  std::iota(group.begin(), group.end(), 0);
+  std::vector<size_t> order;
+  order.reserve(blocks.size());
+  xyCut(blocks, std::move(group), true, order);
+  return order;
+}
@@ -0,0 +1,54 @@
+// src/cpp/layout.h
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <cstddef>
+#include <vector>
+
+// Geometry of one word as reported by poppler::text_box
+struct LayoutBox {
+  double x, y, width, height;
+  int rotation; // 0-3, quarter turns as reported by text_box::rotation()
+};
+
+struct LayoutOptions {
+  // Words join a line when their centres are within this fraction of the
+  // line's font height (box height across the baseline)
+  double lineTolerance = 0.5;
+  // Split a line where the gap between words exceeds this many font
+  // heights; 0 disables column detection
+  double columnGap = 0.0;
+  // Stack lines into a block while the gap between them is at most this
+  // many font heights
+  double blockGap = 1.0;
+};
+
+struct LayoutLine {
+  std::vector<size_t> boxes; // indices into the input, in baseline order
+  double x0, y0, x1, y1;     // bounding box
+  int rotation;
+};
+
+struct LayoutBlock {
+  std::vector<size_t> lines; // indices into the lines passed to BuildBlocks
+  double x0, y0, x1, y1;
+};
+
+// Groups words into lines by sorting on the cross-baseline centre and
+// sweeping once, so the cost is O(n log n) and does not depend on input
+// order. Lines come back top to bottom per rotation.
+std::vector<LayoutLine> BuildLines(const std::vector<LayoutBox>& boxes, const LayoutOptions& options);
+
+// Clusters lines (as returned by BuildLines) into blocks of vertically
+// adjacent, horizontally overlapping lines
+std::vector<LayoutBlock> BuildBlocks(const std::vector<LayoutLine>& lines, const LayoutOptions& options);
+
+// Orders blocks for reading by recursive XY cut: blocks are split into
+// bands at every horizontal gap no block crosses (read top to bottom), a
+// band into columns at every vertical gap (read left to right), and so on
+// until a group cannot be cut. So headings and footers spanning several
+// columns are read before and after them rather than interleaved.
+// Returns indices into `blocks`.
+std::vector<size_t> ReadingOrder(const std::vector<LayoutBlock>& blocks);
+
+#endif // LAYOUT_H
@@ -0,0 +1,95 @@
+// src/cpp/mapped_file.cpp
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& path, std::string* error) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    *error = "Failed to open file";
+    return nullptr;
+  }
+  
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    *error = "Failed to map empty or unreadable file";
+    return nullptr;
+  }
+  
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file); // the mapping keeps the file open
+  if (!mapping) {
+    *error = "Failed to map file";
+    return nullptr;
+  }
+  
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    CloseHandle(mapping);
+    *error = "Failed to map file";
+    return nullptr;
+  }
+  
+  std::shared_ptr<MappedFile> result(new MappedFile());
+  result->data_ = static_cast<const char*>(view);
+  result->length_ = static_cast<size_t>(size.QuadPart);
+  result->mapping_ = mapping;
+  return result;
+}
+
+MappedFile::~MappedFile() {
+  if (data_) UnmapViewOfFile(data_);
+  if (mapping_) CloseHandle(mapping_);
+}
+
+#else
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& path, std::string* error) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    *error = std::string("Failed to open file: ") + std::strerror(errno);
+    return nullptr;
+  }
+  
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    *error = "Failed to map empty or unreadable file";
+    return nullptr;
+  }
+  
+  void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // the mapping keeps the file open
+  if (view == MAP_FAILED) {
+    *error = std::string("Failed to map file: ") + std::strerror(errno);
+    return nullptr;
+  }
+  
+  // poppler jumps between the trailer, xref and objects; sequential
+  // read-ahead would mostly fault in pages it never touches
+  madvise(view, static_cast<size_t>(st.st_size), MADV_RANDOM);
+  
+  std::shared_ptr<MappedFile> result(new MappedFile());
+  result->data_ = static_cast<const char*>(view);
+  result->length_ = static_cast<size_t>(st.st_size);
+  return result;
+}
+
+MappedFile::~MappedFile() {
+  if (data_) munmap(const_cast<char*>(data_), length_);
+}
+
+#endif
@@ -0,0 +1,35 @@
+// src/cpp/mapped_file.h
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are faulted in from the
+// kernel page cache on first access, so opening is O(1) in the file size and
+// only the parts poppler actually reads become resident.
+class MappedFile {
+public:
+  // Returns nullptr and sets `error` if the file cannot be mapped
+  static std::shared_ptr<MappedFile> Open(const std::string& path, std::string* error);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* Data() const { return data_; }
+  size_t Length() const { return length_; }
+
+private:
+  MappedFile() = default;
+
+  const char* data_ = nullptr;
+  size_t length_ = 0;
+#ifdef _WIN32
+  void* mapping_ = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_H
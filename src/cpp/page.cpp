@@ -2,9 +2,187 @@
 #include "page.h"
 #include <poppler/cpp/poppler-page-renderer.h>
 #include <poppler/cpp/poppler-image.h>
+#include "addon_data.h"
+#include "async_task.h"
+#include "cancel.h"
+#include "render.h"
+#include "layout.h"
+#include "page_json.h"
+#include "stats.h"
 #include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 
-Napi::FunctionReference Page::constructor;
+namespace {
+
+// Renders on a pool thread with a private copy of the document and its own
+// renderer, so the document mutex is never taken off the JS thread and
+// renders of one document run in parallel. With a target the output is
+// written into caller memory (which the caller pins) instead of being
+// returned as a new Buffer.
+class RenderTask : public AsyncTask {
+public:
+  RenderTask(Napi::Env env, std::shared_ptr<DocumentHandle> handle, DocumentSource source, int renderHints,
+             int pageIndex, RenderOptions options, std::shared_ptr<const CancelToken> cancel,
+             char* target = nullptr, size_t targetLength = 0)
+      : AsyncTask(env), handle_(std::move(handle)), source_(std::move(source)), renderHints_(renderHints),
+        pageIndex_(pageIndex), options_(options), cancel_(std::move(cancel)), target_(target),
+        targetLength_(targetLength) {
+    output_.encoding = options.encoding;
+  }
+
+protected:
+  void Execute() override {
+    try {
+      CheckCancelled(cancel_);
+      std::unique_ptr<poppler::document> doc = handle_->TakeSpare(source_);
+      if (!doc) {
+        SetError("Failed to open document on worker thread");
+        return;
+      }
+      
+      {
+        std::unique_ptr<poppler::page> page;
+        {
+          StatsTimer timer(Stats::Global().pageCreate, "pageCreate");
+          page.reset(doc->create_page(pageIndex_));
+        }
+        if (!page) {
+          SetError("Failed to create page " + std::to_string(pageIndex_));
+          return;
+        }
+        
+        poppler::page_renderer renderer;
+        renderer.set_render_hints(renderHints_);
+        output_.image = RenderPage(renderer, page.get(), options_);
+      }
+      handle_->ReturnSpare(std::move(doc));
+      
+      if (!output_.image.is_valid()) {
+        SetError("Failed to render page");
+        return;
+      }
+      
+      CheckCancelled(cancel_);
+      if (!target_) {
+        EncodeRenderOutput(output_);
+      } else if (!WriteRenderOutput(output_, target_, targetLength_)) {
+        SetError("Target buffer is too small: need " +
+                 std::to_string(RenderOutputByteLength(output_)) + " bytes");
+      }
+    } catch (const std::exception& e) {
+      SetError(std::string("Error rendering page: ") + e.what());
+    }
+  }
+
+  Napi::Value OnOK(Napi::Env env) override {
+    return target_ ? RenderOutputInfoToObject(env, output_) : RenderOutputToObject(env, output_);
+  }
+
+private:
+  std::shared_ptr<DocumentHandle> handle_;
+  DocumentSource source_;
+  int renderHints_;
+  int pageIndex_;
+  RenderOptions options_;
+  std::shared_ptr<const CancelToken> cancel_;
+  char* target_;
+  size_t targetLength_;
+  RenderOutput output_;
+};
+
+// Creates a RenderTask from the document's current source and render hints
+RenderTask* newRenderTask(Napi::Env env, const std::shared_ptr<DocumentHandle>& handle, int pageIndex,
+                          const RenderOptions& options, std::shared_ptr<const CancelToken> cancel,
+                          char* target = nullptr, size_t targetLength = 0) {
+  std::lock_guard<std::mutex> lock(handle->mutex);
+  return new RenderTask(env, handle, handle->source, handle->renderer.render_hints(), pageIndex, options,
+                        std::move(cancel), target, targetLength);
+}
+
+// Writes x, y, width, height of every box into a new typed array
+template <typename T>
+Napi::TypedArrayOf<T> packBoxes(Napi::Env env, const std::vector<poppler::text_box>& boxes,
+                                napi_typedarray_type type) {
+  Napi::TypedArrayOf<T> result = Napi::TypedArrayOf<T>::New(env, boxes.size() * 4, type);
+  T* out = result.Data();
+  for (const auto& box : boxes) {
+    poppler::rectf bbox = box.bbox();
+    *out++ = static_cast<T>(bbox.x());
+    *out++ = static_cast<T>(bbox.y());
+    *out++ = static_cast<T>(bbox.width());
+    *out++ = static_cast<T>(bbox.height());
+  }
+  return result;
+}
+
+bool isDefaultLineLayout(const LayoutOptions& options) {
+  LayoutOptions defaults;
+  return options.lineTolerance == defaults.lineTolerance && options.columnGap == defaults.columnGap;
+}
+
+// Reads { maxTextBoxes } (0: no limit). Throws a JS exception and returns
+// false on an invalid value.
+bool parseMaxTextBoxes(Napi::Value value, size_t* limit) {
+  *limit = 0;
+  if (!value.IsObject() || !value.As<Napi::Object>().Has("maxTextBoxes")) {
+    return true;
+  }
+  
+  Napi::Value limitValue = value.As<Napi::Object>().Get("maxTextBoxes");
+  if (!limitValue.IsNumber() || limitValue.As<Napi::Number>().DoubleValue() < 0) {
+    Napi::TypeError::New(value.Env(), "Expected maxTextBoxes to be a non-negative number")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+  *limit = static_cast<size_t>(limitValue.As<Napi::Number>().DoubleValue());
+  return true;
+}
+
+// poppler builds the whole box list before we see it, so the limit stops
+// the per-box conversion, layout and JS objects that would follow
+void checkTextBoxLimit(size_t count, size_t limit) {
+  if (limit > 0 && count > limit) {
+    throw std::runtime_error("Page has " + std::to_string(count) + " text boxes, over maxTextBoxes (" +
+                             std::to_string(limit) + ")");
+  }
+}
+
+// Default columnGap of getText({ mode: 'reading' }): wider than any word
+// space in justified text, narrower than a typical column gutter
+const double kReadingColumnGap = 1.0;
+
+// Writes the words of each block in `order` into one string: words joined
+// by spaces, each line ending in a newline, and a blank line between blocks
+std::string readingOrderText(const PageLayout& layout, const std::vector<LayoutBlock>& blocks,
+                             const std::vector<size_t>& order) {
+  size_t size = 2 * blocks.size();
+  for (std::string_view word : layout.wordTexts) {
+    size += word.size() + 1;
+  }
+  
+  std::string text;
+  text.reserve(size);
+  for (size_t blockIdx : order) {
+    if (!text.empty()) {
+      text += '\n';
+    }
+    for (size_t lineIdx : blocks[blockIdx].lines) {
+      const LayoutLine& line = layout.lines[lineIdx];
+      for (size_t i = 0; i < line.boxes.size(); ++i) {
+        if (i > 0) {
+          text += ' ';
+        }
+        text.append(layout.wordTexts[line.boxes[i]]);
+      }
+      text += '\n';
+    }
+  }
+  return text;
+}
+
+} // namespace
 
 Napi::Object Page::Init(Napi::Env env, Napi::Object exports) {
   Napi::HandleScope scope(env);
@@ -13,30 +191,96 @@ Napi::Object Page::Init(Napi::Env env, Napi::Object exports) {
     InstanceMethod("getSize", &Page::GetSize),
     InstanceMethod("getText", &Page::GetText),
     InstanceMethod("renderToImage", &Page::RenderToImage),
+    InstanceMethod("renderToImageAsync", &Page::RenderToImageAsync),
+    InstanceMethod("renderInto", &Page::RenderInto),
+    InstanceMethod("renderIntoAsync", &Page::RenderIntoAsync),
     InstanceMethod("getRotation", &Page::GetRotation),
     InstanceMethod("getDuration", &Page::GetDuration),
     InstanceMethod("getTextBoxes", &Page::GetTextBoxes),
-    InstanceMethod("exportToJSON", &Page::ExportToJSON)
+    InstanceMethod("getTextBoxesColumnar", &Page::GetTextBoxesColumnar),
+    InstanceMethod("exportToJSON", &Page::ExportToJSON),
+    InstanceMethod("dispose", &Page::Dispose)
   });
+  DefineDisposeSymbol(env, func);
   
-  constructor = Napi::Persistent(func);
-  constructor.SuppressDestruct();
+  AddonData::Get(env)->pageConstructor = Napi::Persistent(func);
   
   exports.Set("Page", func);
   return exports;
 }
 
-Napi::Object Page::NewInstance(Napi::Env env, std::unique_ptr<poppler::page> page) {
-  Napi::Object instance = constructor.New({});
+Napi::Object Page::NewInstance(Napi::Env env, Napi::Object document, std::shared_ptr<DocumentHandle> handle,
+                               std::shared_ptr<poppler::page> page, int index) {
+  Napi::Object instance = AddonData::Get(env)->pageConstructor.New({});
   Page* pageWrapper = Napi::ObjectWrap<Page>::Unwrap(instance);
+  pageWrapper->document_ = Napi::Persistent(document);
+  pageWrapper->handle_ = std::move(handle);
   pageWrapper->page_ = std::move(page);
+  pageWrapper->index_ = index;
+  Stats::Global().livePages.fetch_add(1, std::memory_order_relaxed);
   return instance;
 }
 
+std::shared_ptr<const PageRecord> Page::CachedRecord() {
+  std::shared_ptr<const ExtractionCache> cache;
+  std::string key;
+  {
+    std::lock_guard<std::mutex> lock(handle_->mutex);
+    cache = handle_->extraction;
+    key = handle_->contentKey;
+  }
+  
+  if (cache != recordCache_) {
+    // setExtractionCache() was called since the record was loaded
+    record_.reset();
+    recordCache_ = cache;
+  }
+  if (!cache) {
+    return nullptr;
+  }
+  if (record_) {
+    return record_;
+  }
+  
+  record_ = cache->Load(key, index_);
+  if (!record_) {
+    auto blob = std::make_shared<std::vector<char>>();
+    {
+      std::lock_guard<std::mutex> lock(handle_->mutex);
+      *blob = PageRecord::Build(*page_);
+    }
+    cache->Store(key, index_, *blob);
+    record_ = PageRecord::Parse(blob, blob->data(), blob->size());
+  }
+  return record_;
+}
+
 Page::Page(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Page>(info) {
   // Private constructor
 }
 
+Page::~Page() {
+  if (page_) {
+    Stats::Global().livePages.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+Napi::Value Page::Dispose(const Napi::CallbackInfo& info) {
+  if (page_) {
+    Stats::Global().livePages.fetch_sub(1, std::memory_order_relaxed);
+  }
+  
+  // In-flight renders hold their own references, so this only frees what
+  // nothing else is using; the document goes once its last user lets go
+  page_.reset();
+  record_.reset();
+  recordCache_.reset();
+  handle_.reset();
+  document_.Reset();
+  
+  return info.Env().Undefined();
+}
+
 Napi::Value Page::GetSize(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   
@@ -45,6 +289,8 @@ Napi::Value Page::GetSize(const Napi::CallbackInfo& info) {
     return env.Null();
   }
   
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
   poppler::rectf size = page_->page_rect();
   
   Napi::Object result = Napi::Object::New(env);
@@ -64,10 +310,76 @@ Napi::Value Page::GetText(const Napi::CallbackInfo& info) {
     return env.Null();
   }
   
-  poppler::ustring text = page_->text();
-  poppler::byte_array utf8_bytes = text.to_utf8();
-  std::string utf8_text(utf8_bytes.data(), utf8_bytes.size());
-  return Napi::String::New(env, utf8_text);
+  std::string mode = "default";
+  LayoutOptions layoutOptions;
+  layoutOptions.columnGap = kReadingColumnGap;
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
+    
+    if (options.Has("mode")) {
+      mode = options.Get("mode").ToString().Utf8Value();
+      if (mode != "default" && mode != "raw" && mode != "reading") {
+        Napi::TypeError::New(env, "Expected mode to be 'default', 'raw' or 'reading'")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    }
+    
+    if (options.Has("lineTolerance")) {
+      layoutOptions.lineTolerance = options.Get("lineTolerance").As<Napi::Number>().DoubleValue();
+    }
+    
+    if (options.Has("columnGap")) {
+      layoutOptions.columnGap = options.Get("columnGap").As<Napi::Number>().DoubleValue();
+    }
+    
+    if (options.Has("blockGap")) {
+      layoutOptions.blockGap = options.Get("blockGap").As<Napi::Number>().DoubleValue();
+    }
+  }
+  
+  if (mode == "reading") {
+    size_t maxTextBoxes;
+    if (!parseMaxTextBoxes(info[0], &maxTextBoxes)) {
+      return env.Null();
+    }
+    
+    try {
+      std::vector<std::string> wordStorage;
+      PageLayout layout;
+      ExtractLayout(layout, wordStorage, layoutOptions, true, true, maxTextBoxes);
+      std::vector<LayoutBlock> blocks = BuildBlocks(layout.lines, layoutOptions);
+      std::string text = readingOrderText(layout, blocks, ReadingOrder(blocks));
+      CountCopiedToJs(text.size());
+      return Napi::String::New(env, text);
+    } catch (const std::exception& e) {
+      Napi::Error::New(env, std::string("Error extracting text: ") + e.what()).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+  
+  if (mode == "default") {
+    std::shared_ptr<const PageRecord> record = CachedRecord();
+    if (record) {
+      CountCopiedToJs(record->Text().size());
+      return Napi::String::New(env, record->Text().data(), record->Text().size());
+    }
+  }
+  
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
+  poppler::byte_array utf8_bytes;
+  {
+    StatsTimer timer(Stats::Global().textExtract, "textExtract");
+    if (mode == "default") {
+      // poppler's physical layout: columns and spacing kept as on the page
+      utf8_bytes = page_->text().to_utf8();
+    } else {
+      utf8_bytes = page_->text(poppler::rectf(), poppler::page::raw_order_layout).to_utf8();
+    }
+  }
+  CountCopiedToJs(utf8_bytes.size());
+  return Napi::String::New(env, utf8_bytes.data(), utf8_bytes.size());
 }
 
 Napi::Value Page::RenderToImage(const Napi::CallbackInfo& info) {
@@ -78,61 +390,125 @@ Napi::Value Page::RenderToImage(const Napi::CallbackInfo& info) {
     return env.Null();
   }
   
-  // Default rendering options
-  double dpi = 72.0;
-  int rotation = 0;
+  RenderOptions options;
+  if (!ParseRenderOptions(info[0], &options)) {
+    return env.Null();
+  }
   
-  // Parse options if provided
-  if (info.Length() > 0 && info[0].IsObject()) {
-    Napi::Object options = info[0].As<Napi::Object>();
-    
-    if (options.Has("dpi")) {
-      dpi = options.Get("dpi").As<Napi::Number>().DoubleValue();
+  try {
+    RenderOutput output;
+    output.encoding = options.encoding;
+    {
+      std::lock_guard<std::mutex> lock(handle_->mutex);
+      output.image = RenderPage(handle_->renderer, page_.get(), options);
     }
     
-    if (options.Has("rotation")) {
-      rotation = options.Get("rotation").As<Napi::Number>().Int32Value();
+    if (!output.image.is_valid()) {
+      Napi::Error::New(env, "Failed to render page").ThrowAsJavaScriptException();
+      return env.Null();
     }
+    
+    EncodeRenderOutput(output);
+    return RenderOutputToObject(env, output);
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, std::string("Error rendering page: ") + e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value Page::RenderToImageAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!page_) {
+    Napi::Error::New(env, "Page not initialized").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  RenderOptions options;
+  std::shared_ptr<CancelToken> cancel;
+  if (!ParseRenderOptions(info[0], &options) || !ParseCancelToken(info[0], &cancel)) {
+    return env.Null();
+  }
+  
+  // The task shares the document, so dispose() or collecting the Page
+  // while the render runs is safe
+  RenderTask* task = newRenderTask(env, handle_, index_, options, cancel);
+  return task->Queue();
+}
+
+Napi::Value Page::RenderInto(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!page_) {
+    Napi::Error::New(env, "Page not initialized").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  char* target;
+  size_t targetLength;
+  if (info.Length() < 1 || !GetWritableBytes(info[0], &target, &targetLength)) {
+    Napi::TypeError::New(env, "Expected Buffer, TypedArray or ArrayBuffer").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  RenderOptions options;
+  if (!ParseRenderOptions(info[1], &options)) {
+    return env.Null();
   }
   
   try {
-    poppler::page_renderer renderer;
-    renderer.set_render_hint(poppler::page_renderer::antialiasing, true);
-    renderer.set_render_hint(poppler::page_renderer::text_antialiasing, true);
-    
-    poppler::image image = renderer.render_page(page_.get(), dpi, dpi, 
-                                               -1, -1, -1, -1, 
-                                               static_cast<poppler::rotation_enum>(rotation));
+    RenderOutput output;
+    output.encoding = options.encoding;
+    {
+      std::lock_guard<std::mutex> lock(handle_->mutex);
+      output.image = RenderPage(handle_->renderer, page_.get(), options);
+    }
     
-    if (!image.is_valid()) {
+    if (!output.image.is_valid()) {
       Napi::Error::New(env, "Failed to render page").ThrowAsJavaScriptException();
       return env.Null();
     }
     
-    // Convert image to buffer
-    const char* data = image.const_data();
-    int width = image.width();
-    int height = image.height();
-    int bytes_per_row = image.bytes_per_row();
-    
-    // Create buffer with image data
-    size_t dataSize = height * bytes_per_row;
-    Napi::Buffer<char> buffer = Napi::Buffer<char>::Copy(env, data, dataSize);
-    
-    Napi::Object result = Napi::Object::New(env);
-    result.Set("data", buffer);
-    result.Set("width", Napi::Number::New(env, width));
-    result.Set("height", Napi::Number::New(env, height));
-    result.Set("bytesPerRow", Napi::Number::New(env, bytes_per_row));
-    result.Set("format", Napi::String::New(env, "ARGB32")); // Poppler uses ARGB32
+    if (!WriteRenderOutput(output, target, targetLength)) {
+      Napi::RangeError::New(env, "Target buffer is too small: need " +
+                                 std::to_string(RenderOutputByteLength(output)) + " bytes").ThrowAsJavaScriptException();
+      return env.Null();
+    }
     
-    return result;
+    return RenderOutputInfoToObject(env, output);
   } catch (const std::exception& e) {
     Napi::Error::New(env, std::string("Error rendering page: ") + e.what()).ThrowAsJavaScriptException();
     return env.Null();
   }
 }
 
+Napi::Value Page::RenderIntoAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!page_) {
+    Napi::Error::New(env, "Page not initialized").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  char* target;
+  size_t targetLength;
+  if (info.Length() < 1 || !GetWritableBytes(info[0], &target, &targetLength)) {
+    Napi::TypeError::New(env, "Expected Buffer, TypedArray or ArrayBuffer").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  RenderOptions options;
+  std::shared_ptr<CancelToken> cancel;
+  if (!ParseRenderOptions(info[1], &options) || !ParseCancelToken(info[1], &cancel)) {
+    return env.Null();
+  }
+  
+  RenderTask* task = newRenderTask(env, handle_, index_, options, cancel, target, targetLength);
+  // Keeps the target memory valid while the worker writes into it
+  task->Pin(info[0].As<Napi::Object>());
+  return task->Queue();
+}
+
 Napi::Value Page::GetRotation(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   
@@ -141,6 +517,8 @@ Napi::Value Page::GetRotation(const Napi::CallbackInfo& info) {
     return env.Null();
   }
   
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
   return Napi::Number::New(env, static_cast<int>(page_->orientation()));
 }
 
@@ -152,6 +530,8 @@ Napi::Value Page::GetDuration(const Napi::CallbackInfo& info) {
     return env.Null();
   }
   
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  
   return Napi::Number::New(env, page_->duration());
 }
 
@@ -163,8 +543,39 @@ Napi::Value Page::GetTextBoxes(const Napi::CallbackInfo& info) {
     return env.Null();
   }
   
+  size_t maxTextBoxes;
+  if (!parseMaxTextBoxes(info[0], &maxTextBoxes)) {
+    return env.Null();
+  }
+  
   try {
-    std::vector<poppler::text_box> textBoxes = page_->text_list();
+    std::shared_ptr<const PageRecord> record = CachedRecord();
+    if (record) {
+      checkTextBoxLimit(record->WordCount(), maxTextBoxes);
+      Napi::Array result = Napi::Array::New(env, record->WordCount());
+      
+      for (size_t i = 0; i < record->WordCount(); ++i) {
+        std::string_view text = record->WordText(i);
+        LayoutBox box = record->WordBox(i);
+        
+        Napi::Object textBoxObj = Napi::Object::New(env);
+        CountCopiedToJs(text.size());
+        textBoxObj.Set("text", Napi::String::New(env, text.data(), text.size()));
+        textBoxObj.Set("bbox", BboxToObject(env, box.x, box.y, box.width, box.height));
+        result.Set(i, textBoxObj);
+      }
+      
+      return result;
+    }
+    
+    std::lock_guard<std::mutex> lock(handle_->mutex);
+    
+    std::vector<poppler::text_box> textBoxes;
+    {
+      StatsTimer timer(Stats::Global().textExtract, "textExtract");
+      textBoxes = page_->text_list();
+    }
+    checkTextBoxLimit(textBoxes.size(), maxTextBoxes);
     Napi::Array result = Napi::Array::New(env, textBoxes.size());
     
     for (size_t i = 0; i < textBoxes.size(); ++i) {
@@ -174,6 +585,7 @@ Napi::Value Page::GetTextBoxes(const Napi::CallbackInfo& info) {
       // Get text
       poppler::byte_array utf8_bytes = box.text().to_utf8();
       std::string text(utf8_bytes.data(), utf8_bytes.size());
+      CountCopiedToJs(text.size());
       textBoxObj.Set("text", Napi::String::New(env, text));
       
       // Get bounding box
@@ -194,7 +606,7 @@ Napi::Value Page::GetTextBoxes(const Napi::CallbackInfo& info) {
   }
 }
 
-Napi::Value Page::ExportToJSON(const Napi::CallbackInfo& info) {
+Napi::Value Page::GetTextBoxesColumnar(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   
   if (!page_) {
@@ -202,139 +614,218 @@ Napi::Value Page::ExportToJSON(const Napi::CallbackInfo& info) {
     return env.Null();
   }
   
+  bool useFloat32 = false;
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
+    if (options.Has("precision")) {
+      std::string precision = options.Get("precision").ToString().Utf8Value();
+      if (precision != "float32" && precision != "float64") {
+        Napi::TypeError::New(env, "Expected precision to be 'float32' or 'float64'").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      useFloat32 = precision == "float32";
+    }
+  }
+  
+  size_t maxTextBoxes;
+  if (!parseMaxTextBoxes(info[0], &maxTextBoxes)) {
+    return env.Null();
+  }
+  
   try {
-    // Get text boxes
-    std::vector<poppler::text_box> textBoxes = page_->text_list();
-    
-    // Group text boxes into lines
-    std::vector<std::vector<poppler::text_box>> lines = groupTextBoxesIntoLines(std::move(textBoxes));
+    std::vector<poppler::text_box> textBoxes;
+    {
+      std::lock_guard<std::mutex> lock(handle_->mutex);
+      StatsTimer timer(Stats::Global().textExtract, "textExtract");
+      textBoxes = page_->text_list();
+    }
+    checkTextBoxLimit(textBoxes.size(), maxTextBoxes);
     
-    // Sort lines by Y coordinate (top to bottom)
-    std::sort(lines.begin(), lines.end(), [](const std::vector<poppler::text_box>& a, 
-                                            const std::vector<poppler::text_box>& b) {
-      if (a.empty() || b.empty()) return false;
-      return a[0].bbox().y() > b[0].bbox().y();
-    });
+    // Word i is text[offsets[i] .. offsets[i + 1]) in UTF-8
+    Napi::Uint32Array offsets = Napi::Uint32Array::New(env, textBoxes.size() + 1, napi_uint32_array);
+    auto text = std::make_unique<std::vector<char>>();
+    text->reserve(textBoxes.size() * 8 + 1); // rough guess; also keeps data() non-null
+    for (size_t i = 0; i < textBoxes.size(); ++i) {
+      offsets[i] = static_cast<uint32_t>(text->size());
+      poppler::byte_array utf8_bytes = textBoxes[i].text().to_utf8();
+      text->insert(text->end(), utf8_bytes.begin(), utf8_bytes.end());
+    }
+    offsets[textBoxes.size()] = static_cast<uint32_t>(text->size());
+    // The text is handed over as is; the arrays are filled in JS memory
+    CountCopiedToJs(offsets.ByteLength() + textBoxes.size() * 4 * (useFloat32 ? sizeof(float) : sizeof(double)));
     
-    // Build JSON structure
     Napi::Object result = Napi::Object::New(env);
+    result.Set("count", Napi::Number::New(env, textBoxes.size()));
+    if (useFloat32) {
+      result.Set("bboxes", packBoxes<float>(env, textBoxes, napi_float32_array));
+    } else {
+      result.Set("bboxes", packBoxes<double>(env, textBoxes, napi_float64_array));
+    }
+    result.Set("text", NewTrackedBuffer(env, std::move(*text)));
+    result.Set("offsets", offsets);
     
-    // Page info
-    Napi::Object pageInfo = Napi::Object::New(env);
-    auto rect = page_->page_rect();
-    pageInfo.Set("width", Napi::Number::New(env, rect.width()));
-    pageInfo.Set("height", Napi::Number::New(env, rect.height()));
-    pageInfo.Set("rotation", Napi::Number::New(env, static_cast<int>(page_->orientation())));
-    result.Set("page", pageInfo);
-    
-    // Lines array
-    Napi::Array linesArray = Napi::Array::New(env, lines.size());
-    
-    for (size_t lineIdx = 0; lineIdx < lines.size(); ++lineIdx) {
-      auto& line = lines[lineIdx];
-      
-      // Sort words in line by X coordinate
-      std::sort(line.begin(), line.end(), [](const poppler::text_box& a, 
-                                            const poppler::text_box& b) {
-        return a.bbox().x() < b.bbox().x();
-      });
-      
-      Napi::Object lineObj = Napi::Object::New(env);
-      
-      // Line text
-      std::string lineText;
-      for (size_t i = 0; i < line.size(); ++i) {
-        if (i > 0) lineText += " ";
-        poppler::byte_array utf8_bytes = line[i].text().to_utf8();
-        lineText += std::string(utf8_bytes.data(), utf8_bytes.size());
+    return result;
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, std::string("Error getting text boxes: ") + e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+void Page::ExtractLayout(PageLayout& layout, std::vector<std::string>& wordStorage,
+                         const LayoutOptions& layoutOptions, bool needBoxes, bool needText,
+                         size_t maxTextBoxes) {
+  // record_ keeps the record, and so the word texts, alive
+  std::shared_ptr<const PageRecord> record = needBoxes ? CachedRecord() : nullptr;
+  
+  if (record) {
+    checkTextBoxLimit(record->WordCount(), maxTextBoxes);
+    layout.width = record->Width();
+    layout.height = record->Height();
+    layout.rotation = record->Rotation();
+    layout.boxes.reserve(record->WordCount());
+    for (size_t i = 0; i < record->WordCount(); ++i) {
+      layout.boxes.push_back(record->WordBox(i));
+    }
+    if (needText) {
+      layout.wordTexts.reserve(record->WordCount());
+      for (size_t i = 0; i < record->WordCount(); ++i) {
+        layout.wordTexts.push_back(record->WordText(i));
       }
-      lineObj.Set("text", Napi::String::New(env, lineText));
-      
-      // Line bounding box
-      if (!line.empty()) {
-        double minX = line[0].bbox().x();
-        double maxX = line[0].bbox().x() + line[0].bbox().width();
-        double minY = line[0].bbox().y();
-        double maxY = line[0].bbox().y() + line[0].bbox().height();
-        
-        for (const auto& box : line) {
-          minX = std::min(minX, box.bbox().x());
-          maxX = std::max(maxX, box.bbox().x() + box.bbox().width());
-          minY = std::min(minY, box.bbox().y());
-          maxY = std::max(maxY, box.bbox().y() + box.bbox().height());
-        }
-        
-        Napi::Object lineBbox = Napi::Object::New(env);
-        lineBbox.Set("x", Napi::Number::New(env, minX));
-        lineBbox.Set("y", Napi::Number::New(env, minY));
-        lineBbox.Set("width", Napi::Number::New(env, maxX - minX));
-        lineBbox.Set("height", Napi::Number::New(env, maxY - minY));
-        lineObj.Set("bbox", lineBbox);
+    }
+    // The record already holds the lines for the default options
+    layout.lines = isDefaultLineLayout(layoutOptions) ? record->Lines() : BuildLines(layout.boxes, layoutOptions);
+  } else {
+    std::vector<poppler::text_box> textBoxes;
+    poppler::rectf rect;
+    {
+      std::lock_guard<std::mutex> lock(handle_->mutex);
+      if (needBoxes) {
+        StatsTimer timer(Stats::Global().textExtract, "textExtract");
+        textBoxes = page_->text_list();
       }
-      
-      // Words array
-      Napi::Array wordsArray = Napi::Array::New(env, line.size());
-      for (size_t wordIdx = 0; wordIdx < line.size(); ++wordIdx) {
-        const auto& box = line[wordIdx];
-        Napi::Object wordObj = Napi::Object::New(env);
-        
+      rect = page_->page_rect();
+      layout.rotation = static_cast<int>(page_->orientation());
+    }
+    checkTextBoxLimit(textBoxes.size(), maxTextBoxes);
+    layout.width = rect.width();
+    layout.height = rect.height();
+    
+    // Each word is converted to UTF-8 once, and only if it is emitted
+    layout.boxes.reserve(textBoxes.size());
+    for (const auto& box : textBoxes) {
+      poppler::rectf bbox = box.bbox();
+      layout.boxes.push_back({ bbox.x(), bbox.y(), bbox.width(), bbox.height(), box.rotation() });
+    }
+    if (needText) {
+      wordStorage.reserve(textBoxes.size());
+      for (const auto& box : textBoxes) {
         poppler::byte_array utf8_bytes = box.text().to_utf8();
-        std::string wordText(utf8_bytes.data(), utf8_bytes.size());
-        wordObj.Set("text", Napi::String::New(env, wordText));
-        
-        Napi::Object wordBbox = Napi::Object::New(env);
-        wordBbox.Set("x", Napi::Number::New(env, box.bbox().x()));
-        wordBbox.Set("y", Napi::Number::New(env, box.bbox().y()));
-        wordBbox.Set("width", Napi::Number::New(env, box.bbox().width()));
-        wordBbox.Set("height", Napi::Number::New(env, box.bbox().height()));
-        wordObj.Set("bbox", wordBbox);
-        
-        wordsArray.Set(wordIdx, wordObj);
+        wordStorage.emplace_back(utf8_bytes.data(), utf8_bytes.size());
       }
-      lineObj.Set("words", wordsArray);
-      
-      linesArray.Set(lineIdx, lineObj);
+      layout.wordTexts.assign(wordStorage.begin(), wordStorage.end());
+    }
+    if (needBoxes) {
+      layout.lines = BuildLines(layout.boxes, layoutOptions);
     }
-    
-    result.Set("lines", linesArray);
-    
-    return result;
-  } catch (const std::exception& e) {
-    Napi::Error::New(env, std::string("Error exporting to JSON: ") + e.what()).ThrowAsJavaScriptException();
-    return env.Null();
   }
 }
 
-std::vector<std::vector<poppler::text_box>> Page::groupTextBoxesIntoLines(
-    std::vector<poppler::text_box>&& textBoxes) {
+Napi::Value Page::ExportToJSON(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
   
-  std::vector<std::vector<poppler::text_box>> lines;
-  const double lineThreshold = 5.0; // Points tolerance for same line
+  if (!page_) {
+    Napi::Error::New(env, "Page not initialized").ThrowAsJavaScriptException();
+    return env.Null();
+  }
   
-  for (auto& box : textBoxes) {
-    bool addedToExistingLine = false;
+  LayoutOptions layoutOptions;
+  PageJsonFields fields;
+  std::string format = "object";
+  bool asBuffer = false;
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
     
-    // Try to add to existing line
-    for (auto& line : lines) {
-      if (!line.empty()) {
-        double lineY = line[0].bbox().y();
-        double boxY = box.bbox().y();
-        
-        if (std::abs(lineY - boxY) < lineThreshold) {
-          line.push_back(std::move(box));
-          addedToExistingLine = true;
-          break;
-        }
+    if (options.Has("lineTolerance")) {
+      layoutOptions.lineTolerance = options.Get("lineTolerance").As<Napi::Number>().DoubleValue();
+    }
+    
+    if (options.Has("columnGap")) {
+      layoutOptions.columnGap = options.Get("columnGap").As<Napi::Number>().DoubleValue();
+    }
+    
+    if (options.Has("blockGap")) {
+      layoutOptions.blockGap = options.Get("blockGap").As<Napi::Number>().DoubleValue();
+    }
+    
+    if (options.Has("blocks")) {
+      fields.blocks = options.Get("blocks").ToBoolean().Value();
+    }
+    
+    if (options.Has("lines")) {
+      fields.lines = options.Get("lines").ToBoolean().Value();
+    }
+    
+    if (options.Has("words")) {
+      fields.words = options.Get("words").ToBoolean().Value();
+    }
+    
+    if (options.Has("bboxes")) {
+      fields.bboxes = options.Get("bboxes").ToBoolean().Value();
+    }
+    
+    if (options.Has("format")) {
+      format = options.Get("format").ToString().Utf8Value();
+      if (format != "object" && format != "json" && format != "ndjson") {
+        Napi::TypeError::New(env, "Expected format to be 'object', 'json' or 'ndjson'").ThrowAsJavaScriptException();
+        return env.Null();
       }
     }
     
-    // Create new line if not added to existing one
-    if (!addedToExistingLine) {
-      std::vector<poppler::text_box> newLine;
-      newLine.push_back(std::move(box));
-      lines.push_back(std::move(newLine));
+    if (options.Has("output")) {
+      std::string output = options.Get("output").ToString().Utf8Value();
+      if (output != "string" && output != "buffer") {
+        Napi::TypeError::New(env, "Expected output to be 'string' or 'buffer'").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      asBuffer = output == "buffer";
     }
   }
   
-  return lines;
-}
\ No newline at end of file
+  size_t maxTextBoxes;
+  if (!parseMaxTextBoxes(info[0], &maxTextBoxes)) {
+    return env.Null();
+  }
+  
+  // Word boxes are only needed to build lines, and word text only when
+  // lines are emitted
+  bool needBoxes = fields.lines || fields.blocks;
+  bool needText = fields.lines;
+  
+  try {
+    // Word texts point into the cached record or into `wordStorage`
+    std::vector<std::string> wordStorage;
+    PageLayout layout;
+    ExtractLayout(layout, wordStorage, layoutOptions, needBoxes, needText, maxTextBoxes);
+    
+    SortLayoutLines(layout);
+    if (fields.blocks) {
+      layout.blocks = BuildBlocks(layout.lines, layoutOptions);
+    }
+    
+    if (format == "object") {
+      return PageLayoutToObject(env, layout, fields);
+    }
+    
+    // Serialized natively: one string instead of an object per word
+    std::string json;
+    WritePageLayoutJson(json, layout, fields, format == "ndjson");
+    if (asBuffer) {
+      return NewTrackedBuffer(env, std::move(json));
+    }
+    CountCopiedToJs(json.size());
+    return Napi::String::New(env, json);
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, std::string("Error exporting to JSON: ") + e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
@@ -5,34 +5,66 @@
 #include <napi.h>
 #include <poppler/cpp/poppler-page.h>
 #include <poppler/cpp/poppler-page-renderer.h>
+#include <cstddef>
 #include <memory>
+#include <string>
+#include <vector>
+#include "document_handle.h"
+
+struct LayoutOptions;
+struct PageLayout;
 
 class Page : public Napi::ObjectWrap<Page> {
 public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
-  static Napi::Object NewInstance(Napi::Env env, std::unique_ptr<poppler::page> page);
+  static Napi::Object NewInstance(Napi::Env env, Napi::Object document, std::shared_ptr<DocumentHandle> handle,
+                                  std::shared_ptr<poppler::page> page, int index);
   
   Page(const Napi::CallbackInfo& info);
+  ~Page();
   
   // Instance methods
   Napi::Value GetSize(const Napi::CallbackInfo& info);
   Napi::Value GetText(const Napi::CallbackInfo& info);
   Napi::Value RenderToImage(const Napi::CallbackInfo& info);
+  Napi::Value RenderToImageAsync(const Napi::CallbackInfo& info);
+  Napi::Value RenderInto(const Napi::CallbackInfo& info);
+  Napi::Value RenderIntoAsync(const Napi::CallbackInfo& info);
   Napi::Value GetRotation(const Napi::CallbackInfo& info);
   Napi::Value GetDuration(const Napi::CallbackInfo& info);
   Napi::Value GetTextBoxes(const Napi::CallbackInfo& info);
+  Napi::Value GetTextBoxesColumnar(const Napi::CallbackInfo& info);
   Napi::Value ExportToJSON(const Napi::CallbackInfo& info);
+  Napi::Value Dispose(const Napi::CallbackInfo& info);
   
   // Getters
   poppler::page* GetPage() const { return page_.get(); }
 
 private:
-  std::unique_ptr<poppler::page> page_;
-  static Napi::FunctionReference constructor;
+  // The page's extraction results from the document's extraction cache,
+  // building and storing them on a miss; nullptr when no cache is set
+  std::shared_ptr<const PageRecord> CachedRecord();
+  
+  // Fills in the page size and, when `needBoxes`, the word boxes and lines
+  // (plus word texts if `needText`), from the extraction cache when one is
+  // set. Word texts point into the cached record or into `wordStorage`.
+  // Throws if the page has more than `maxTextBoxes` words.
+  void ExtractLayout(PageLayout& layout, std::vector<std::string>& wordStorage,
+                     const LayoutOptions& layoutOptions, bool needBoxes, bool needText,
+                     size_t maxTextBoxes);
   
-  // Helper methods
-  std::vector<std::vector<poppler::text_box>> groupTextBoxesIntoLines(
-      std::vector<poppler::text_box>&& textBoxes);
+  // The Document this page came from, kept alive (with the memory it
+  // accounts for) as long as the page is
+  Napi::ObjectReference document_;
+  // Declared before page_ so the page is released while its document is alive
+  std::shared_ptr<DocumentHandle> handle_;
+  // Shared with the document's page cache
+  std::shared_ptr<poppler::page> page_;
+  int index_ = 0;
+  std::shared_ptr<const PageRecord> record_;
+  // The extraction cache record_ came from; a different (or no) cache on
+  // the document makes record_ stale
+  std::shared_ptr<const ExtractionCache> recordCache_;
 };
 
 #endif // PAGE_H
\ No newline at end of file
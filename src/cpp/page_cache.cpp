@@ -0,0 +1,44 @@
+// src/cpp/page_cache.cpp
+#include "page_cache.h"
+#include "stats.h"
+
+std::shared_ptr<poppler::page> PageCache::Get(const poppler::document& doc, int index) {
+  auto found = index_.find(index);
+  if (found != index_.end()) {
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return found->second->second;
+  }
+  
+  ++misses_;
+  std::shared_ptr<poppler::page> page;
+  {
+    StatsTimer timer(Stats::Global().pageCreate, "pageCreate");
+    page.reset(doc.create_page(index));
+  }
+  if (!page || capacity_ == 0) {
+    return page;
+  }
+  
+  entries_.emplace_front(index, page);
+  index_[index] = entries_.begin();
+  Trim();
+  return page;
+}
+
+void PageCache::SetCapacity(size_t capacity) {
+  capacity_ = capacity;
+  Trim();
+}
+
+void PageCache::Clear() {
+  entries_.clear();
+  index_.clear();
+}
+
+void PageCache::Trim() {
+  while (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
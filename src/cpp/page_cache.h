@@ -0,0 +1,45 @@
+// src/cpp/page_cache.h
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <poppler/cpp/poppler-document.h>
+#include <poppler/cpp/poppler-page.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+// Bounded LRU of parsed pages for one document, so repeated getPage()
+// calls skip re-parsing the page dictionary. Pages are shared: evicting a
+// page only drops the cache's reference. Not thread-safe; callers hold the
+// document mutex.
+class PageCache {
+public:
+  explicit PageCache(size_t capacity) : capacity_(capacity) {}
+
+  // Returns the cached page or creates it; nullptr if poppler fails
+  std::shared_ptr<poppler::page> Get(const poppler::document& doc, int index);
+
+  void SetCapacity(size_t capacity);
+  void Clear();
+
+  size_t Capacity() const { return capacity_; }
+  size_t Size() const { return entries_.size(); }
+  uint64_t Hits() const { return hits_; }
+  uint64_t Misses() const { return misses_; }
+
+private:
+  using Entry = std::pair<int, std::shared_ptr<poppler::page>>;
+
+  void Trim();
+
+  size_t capacity_;
+  std::list<Entry> entries_; // most recently used first
+  std::unordered_map<int, std::list<Entry>::iterator> index_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+#endif // PAGE_CACHE_H
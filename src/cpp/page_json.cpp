@@ -0,0 +1,292 @@
+// src/cpp/page_json.cpp
+#include "page_json.h"
+#include "stats.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Floating-point std::to_chars needs libstdc++ 11 or, on Apple, a macOS
+// 13.3 deployment target; elsewhere numbers go through snprintf
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L && !defined(__APPLE__)
+#define POPPLER_JSON_TO_CHARS 1
+#endif
+
+namespace {
+
+// Shortest representation that round-trips, like JSON.stringify for the
+// values a page produces; non-finite numbers become null as they do in JS
+void writeNumber(std::string& out, double value) {
+  if (!std::isfinite(value)) {
+    out += "null";
+    return;
+  }
+  char buffer[32];
+#if defined(POPPLER_JSON_TO_CHARS)
+  std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+#else
+  // 15 significant digits cover almost every coordinate; 17 always round-trip
+  int length = std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+  if (std::strtod(buffer, nullptr) != value) {
+    length = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  }
+  out.append(buffer, static_cast<size_t>(length));
+#endif
+}
+
+// Escapes for a JSON string body; UTF-8 passes through untouched
+void writeEscaped(std::string& out, std::string_view text) {
+  static const char kHex[] = "0123456789abcdef";
+  size_t start = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    out.append(text.data() + start, i - start);
+    start = i + 1;
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      case '\b': out += "\\b"; break;
+      case '\f': out += "\\f"; break;
+      default:
+        out += "\\u00";
+        out += kHex[c >> 4];
+        out += kHex[c & 0xf];
+    }
+  }
+  out.append(text.data() + start, text.size() - start);
+}
+
+void writeBbox(std::string& out, double x, double y, double width, double height) {
+  out += "\"bbox\":{\"x\":";
+  writeNumber(out, x);
+  out += ",\"y\":";
+  writeNumber(out, y);
+  out += ",\"width\":";
+  writeNumber(out, width);
+  out += ",\"height\":";
+  writeNumber(out, height);
+  out += '}';
+}
+
+void writePageInfo(std::string& out, const PageLayout& layout) {
+  out += "\"page\":{\"width\":";
+  writeNumber(out, layout.width);
+  out += ",\"height\":";
+  writeNumber(out, layout.height);
+  out += ",\"rotation\":";
+  writeNumber(out, layout.rotation);
+  out += '}';
+}
+
+void writeLine(std::string& out, const PageLayout& layout, const LayoutLine& line, const PageJsonFields& fields) {
+  // The line text is written word by word, so no joined copy is made
+  out += "{\"text\":\"";
+  for (size_t wordIdx = 0; wordIdx < line.boxes.size(); ++wordIdx) {
+    if (wordIdx > 0) out += ' ';
+    writeEscaped(out, layout.wordTexts[line.boxes[wordIdx]]);
+  }
+  out += '"';
+  
+  if (fields.bboxes) {
+    out += ',';
+    writeBbox(out, line.x0, line.y0, line.x1 - line.x0, line.y1 - line.y0);
+  }
+  
+  if (fields.words) {
+    out += ",\"words\":[";
+    for (size_t wordIdx = 0; wordIdx < line.boxes.size(); ++wordIdx) {
+      const LayoutBox& box = layout.boxes[line.boxes[wordIdx]];
+      if (wordIdx > 0) out += ',';
+      out += "{\"text\":\"";
+      writeEscaped(out, layout.wordTexts[line.boxes[wordIdx]]);
+      out += '"';
+      if (fields.bboxes) {
+        out += ',';
+        writeBbox(out, box.x, box.y, box.width, box.height);
+      }
+      out += '}';
+    }
+    out += ']';
+  }
+  
+  out += '}';
+}
+
+void writeBlocks(std::string& out, const PageLayout& layout, const PageJsonFields& fields,
+                 const std::vector<size_t>& outputIndex) {
+  out += "\"blocks\":[";
+  for (size_t blockIdx = 0; blockIdx < layout.blocks.size(); ++blockIdx) {
+    const LayoutBlock& block = layout.blocks[blockIdx];
+    if (blockIdx > 0) out += ',';
+    out += '{';
+    if (fields.bboxes) {
+      writeBbox(out, block.x0, block.y0, block.x1 - block.x0, block.y1 - block.y0);
+      out += ',';
+    }
+    out += "\"lines\":[";
+    for (size_t i = 0; i < block.lines.size(); ++i) {
+      if (i > 0) out += ',';
+      writeNumber(out, static_cast<double>(outputIndex[block.lines[i]]));
+    }
+    out += "]}";
+  }
+  out += ']';
+}
+
+// Position of each line in the output, for blocks to refer to
+std::vector<size_t> outputIndices(const PageLayout& layout) {
+  std::vector<size_t> outputIndex(layout.lines.size());
+  for (size_t i = 0; i < layout.lineOrder.size(); ++i) {
+    outputIndex[layout.lineOrder[i]] = i;
+  }
+  return outputIndex;
+}
+
+} // namespace
+
+Napi::Object BboxToObject(Napi::Env env, double x, double y, double width, double height) {
+  Napi::Object bbox = Napi::Object::New(env);
+  bbox.Set("x", Napi::Number::New(env, x));
+  bbox.Set("y", Napi::Number::New(env, y));
+  bbox.Set("width", Napi::Number::New(env, width));
+  bbox.Set("height", Napi::Number::New(env, height));
+  return bbox;
+}
+
+void SortLayoutLines(PageLayout& layout) {
+  const std::vector<LayoutLine>& lines = layout.lines;
+  layout.lineOrder.resize(lines.size());
+  for (size_t i = 0; i < lines.size(); ++i) layout.lineOrder[i] = i;
+  std::stable_sort(layout.lineOrder.begin(), layout.lineOrder.end(), [&lines](size_t a, size_t b) {
+    return lines[a].y0 > lines[b].y0;
+  });
+}
+
+Napi::Object PageLayoutToObject(Napi::Env env, const PageLayout& layout, const PageJsonFields& fields) {
+  Napi::Object result = Napi::Object::New(env);
+  
+  // Page info
+  Napi::Object pageInfo = Napi::Object::New(env);
+  pageInfo.Set("width", Napi::Number::New(env, layout.width));
+  pageInfo.Set("height", Napi::Number::New(env, layout.height));
+  pageInfo.Set("rotation", Napi::Number::New(env, layout.rotation));
+  result.Set("page", pageInfo);
+  
+  if (fields.lines) {
+    Napi::Array linesArray = Napi::Array::New(env, layout.lineOrder.size());
+    
+    for (size_t lineIdx = 0; lineIdx < layout.lineOrder.size(); ++lineIdx) {
+      const LayoutLine& line = layout.lines[layout.lineOrder[lineIdx]];
+      Napi::Object lineObj = Napi::Object::New(env);
+      
+      std::string lineText;
+      for (size_t wordIdx = 0; wordIdx < line.boxes.size(); ++wordIdx) {
+        if (wordIdx > 0) lineText += ' ';
+        lineText += layout.wordTexts[line.boxes[wordIdx]];
+      }
+      CountCopiedToJs(lineText.size());
+      lineObj.Set("text", Napi::String::New(env, lineText));
+      
+      if (fields.bboxes) {
+        lineObj.Set("bbox", BboxToObject(env, line.x0, line.y0, line.x1 - line.x0, line.y1 - line.y0));
+      }
+      
+      if (fields.words) {
+        Napi::Array wordsArray = Napi::Array::New(env, line.boxes.size());
+        for (size_t wordIdx = 0; wordIdx < line.boxes.size(); ++wordIdx) {
+          const LayoutBox& box = layout.boxes[line.boxes[wordIdx]];
+          std::string_view wordText = layout.wordTexts[line.boxes[wordIdx]];
+          
+          Napi::Object wordObj = Napi::Object::New(env);
+          CountCopiedToJs(wordText.size());
+          wordObj.Set("text", Napi::String::New(env, wordText.data(), wordText.size()));
+          if (fields.bboxes) {
+            wordObj.Set("bbox", BboxToObject(env, box.x, box.y, box.width, box.height));
+          }
+          wordsArray.Set(wordIdx, wordObj);
+        }
+        lineObj.Set("words", wordsArray);
+      }
+      
+      linesArray.Set(lineIdx, lineObj);
+    }
+    
+    result.Set("lines", linesArray);
+  }
+  
+  if (fields.blocks) {
+    std::vector<size_t> outputIndex = outputIndices(layout);
+    Napi::Array blocksArray = Napi::Array::New(env, layout.blocks.size());
+    
+    for (size_t blockIdx = 0; blockIdx < layout.blocks.size(); ++blockIdx) {
+      const LayoutBlock& block = layout.blocks[blockIdx];
+      Napi::Object blockObj = Napi::Object::New(env);
+      if (fields.bboxes) {
+        blockObj.Set("bbox", BboxToObject(env, block.x0, block.y0, block.x1 - block.x0, block.y1 - block.y0));
+      }
+      
+      // Indices into the lines array
+      Napi::Array lineIndices = Napi::Array::New(env, block.lines.size());
+      for (size_t i = 0; i < block.lines.size(); ++i) {
+        lineIndices.Set(i, Napi::Number::New(env, outputIndex[block.lines[i]]));
+      }
+      blockObj.Set("lines", lineIndices);
+      
+      blocksArray.Set(blockIdx, blockObj);
+    }
+    
+    result.Set("blocks", blocksArray);
+  }
+  
+  return result;
+}
+
+void WritePageLayoutJson(std::string& out, const PageLayout& layout, const PageJsonFields& fields,
+                         bool ndjson) {
+  if (ndjson) {
+    out += '{';
+    writePageInfo(out, layout);
+    out += "}\n";
+    
+    if (fields.lines) {
+      for (size_t lineIdx : layout.lineOrder) {
+        writeLine(out, layout, layout.lines[lineIdx], fields);
+        out += '\n';
+      }
+    }
+    
+    if (fields.blocks) {
+      out += '{';
+      writeBlocks(out, layout, fields, outputIndices(layout));
+      out += "}\n";
+    }
+    return;
+  }
+  
+  out += '{';
+  writePageInfo(out, layout);
+  
+  if (fields.lines) {
+    out += ",\"lines\":[";
+    for (size_t i = 0; i < layout.lineOrder.size(); ++i) {
+      if (i > 0) out += ',';
+      writeLine(out, layout, layout.lines[layout.lineOrder[i]], fields);
+    }
+    out += ']';
+  }
+  
+  if (fields.blocks) {
+    out += ',';
+    writeBlocks(out, layout, fields, outputIndices(layout));
+  }
+  
+  out += '}';
+}
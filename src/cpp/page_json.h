@@ -0,0 +1,50 @@
+// src/cpp/page_json.h
+#ifndef PAGE_JSON_H
+#define PAGE_JSON_H
+
+#include <napi.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "layout.h"
+
+// Which parts of exportToJSON() the caller asked for; anything left out is
+// neither computed nor emitted
+struct PageJsonFields {
+  bool lines = true;   // the lines array (with line text)
+  bool words = true;   // each line's words
+  bool bboxes = true;  // bbox on lines, words and blocks
+  bool blocks = false; // blocks grouping the lines
+};
+
+// Everything exportToJSON() emits, computed once and shared by the object
+// and the JSON writers. Word texts point into storage owned by the caller.
+struct PageLayout {
+  double width = 0;
+  double height = 0;
+  int rotation = 0;
+  std::vector<std::string_view> wordTexts; // empty unless lines are emitted
+  std::vector<LayoutBox> boxes;
+  std::vector<LayoutLine> lines;
+  std::vector<size_t> lineOrder; // output position -> index into lines
+  std::vector<LayoutBlock> blocks;
+};
+
+// Builds a { x, y, width, height } object, as used for every bbox a page
+// reports
+Napi::Object BboxToObject(Napi::Env env, double x, double y, double width, double height);
+
+// Orders lines for output (descending y; ties keep reading order)
+void SortLayoutLines(PageLayout& layout);
+
+// Builds the { page, lines, blocks? } object graph
+Napi::Object PageLayoutToObject(Napi::Env env, const PageLayout& layout, const PageJsonFields& fields);
+
+// Serializes the same structure as JSON. With `ndjson`, writes one record
+// per line instead: { page } first, then each line, then { blocks } if
+// requested, each terminated by '\n'.
+void WritePageLayoutJson(std::string& out, const PageLayout& layout, const PageJsonFields& fields,
+                         bool ndjson);
+
+#endif // PAGE_JSON_H
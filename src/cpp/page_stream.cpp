@@ -0,0 +1,145 @@
+// src/cpp/page_stream.cpp
+#include "page_stream.h"
+#include "result_stream.h"
+#include "stats.h"
+#include <poppler/cpp/poppler-page.h>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+struct WordBox {
+  std::string text;
+  double x, y, width, height;
+};
+
+class PageItem : public StreamItem {
+public:
+  PageItem(std::shared_ptr<const PageStreamOptions> options, int index)
+      : options_(std::move(options)), index_(index) {}
+  
+  std::string text;
+  std::vector<WordBox> boxes;
+  RenderOutput image;
+  
+  Napi::Value ToValue(Napi::Env env) override {
+    Napi::Object value = Napi::Object::New(env);
+    value.Set("index", Napi::Number::New(env, index_));
+    
+    if (options_->text) {
+      CountCopiedToJs(text.size());
+      value.Set("text", Napi::String::New(env, text));
+    }
+    
+    if (options_->boxes) {
+      Napi::Array boxArray = Napi::Array::New(env, boxes.size());
+      for (size_t i = 0; i < boxes.size(); ++i) {
+        const WordBox& box = boxes[i];
+        Napi::Object textBoxObj = Napi::Object::New(env);
+        textBoxObj.Set("text", Napi::String::New(env, box.text));
+        
+        Napi::Object bbox = Napi::Object::New(env);
+        bbox.Set("x", Napi::Number::New(env, box.x));
+        bbox.Set("y", Napi::Number::New(env, box.y));
+        bbox.Set("width", Napi::Number::New(env, box.width));
+        bbox.Set("height", Napi::Number::New(env, box.height));
+        textBoxObj.Set("bbox", bbox);
+        
+        boxArray.Set(i, textBoxObj);
+      }
+      value.Set("boxes", boxArray);
+    }
+    
+    if (options_->render) {
+      value.Set("image", RenderOutputToObject(env, image));
+    }
+    
+    return value;
+  }
+
+private:
+  std::shared_ptr<const PageStreamOptions> options_;
+  int index_;
+};
+
+std::string toUtf8(const poppler::ustring& text) {
+  poppler::byte_array utf8_bytes = text.to_utf8();
+  return std::string(utf8_bytes.data(), utf8_bytes.size());
+}
+
+void producePages(const DocumentSource& source, std::shared_ptr<const PageStreamOptions> shared,
+                  StreamSink& sink) {
+  const PageStreamOptions& options = *shared;
+  
+  std::unique_ptr<poppler::document> doc = source.Open();
+  if (!doc) {
+    throw std::runtime_error("Failed to open document on producer thread");
+  }
+  
+  poppler::page_renderer renderer;
+  renderer.set_render_hints(options.renderHints);
+  
+  for (int index : options.pages) {
+    if (sink.Cancelled()) {
+      break;
+    }
+    CheckCancelled(options.cancel);
+    
+    std::unique_ptr<poppler::page> page;
+    {
+      StatsTimer timer(Stats::Global().pageCreate, "pageCreate");
+      page.reset(doc->create_page(index));
+    }
+    if (!page) {
+      throw std::runtime_error("Failed to create page " + std::to_string(index));
+    }
+    
+    auto item = std::make_unique<PageItem>(shared, index);
+    
+    if (options.text) {
+      StatsTimer timer(Stats::Global().textExtract, "textExtract");
+      item->text = toUtf8(page->text());
+    }
+    
+    if (options.boxes) {
+      std::vector<poppler::text_box> textBoxes;
+      {
+        StatsTimer timer(Stats::Global().textExtract, "textExtract");
+        textBoxes = page->text_list();
+      }
+      item->boxes.reserve(textBoxes.size());
+      for (const auto& box : textBoxes) {
+        poppler::rectf bbox = box.bbox();
+        item->boxes.push_back({ toUtf8(box.text()), bbox.x(), bbox.y(), bbox.width(), bbox.height() });
+      }
+    }
+    
+    if (options.render) {
+      item->image.encoding = options.renderOptions.encoding;
+      item->image.image = RenderPage(renderer, page.get(), options.renderOptions);
+      if (!item->image.image.is_valid()) {
+        throw std::runtime_error("Failed to render page " + std::to_string(index));
+      }
+      CheckCancelled(options.cancel);
+      EncodeRenderOutput(item->image);
+    }
+    
+    // Backpressure: blocks until the consumer has taken enough pages
+    if (!sink.Push(std::move(item))) {
+      break;
+    }
+  }
+}
+
+} // namespace
+
+Napi::Object NewPageStream(Napi::Env env, DocumentSource source, PageStreamOptions options) {
+  // Shared with every item, which may outlive the producer
+  auto shared = std::make_shared<const PageStreamOptions>(std::move(options));
+  size_t prefetch = shared->prefetch;
+  
+  return ResultStream::NewInstance(env, prefetch, "Error streaming pages",
+      [source = std::move(source), shared](StreamSink& sink) {
+        producePages(source, shared, sink);
+      });
+}
@@ -0,0 +1,29 @@
+// src/cpp/page_stream.h
+#ifndef PAGE_STREAM_H
+#define PAGE_STREAM_H
+
+#include <napi.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "cancel.h"
+#include "document_handle.h"
+#include "render.h"
+
+struct PageStreamOptions {
+  std::vector<int> pages;
+  bool text = false;
+  bool boxes = false;
+  bool render = false;
+  RenderOptions renderOptions;
+  int renderHints = 0;
+  size_t prefetch = 2; // pages produced ahead of the consumer
+  std::shared_ptr<const CancelToken> cancel; // ends the stream with an error
+};
+
+// Streams a document's pages as a ResultStream. A dedicated producer thread
+// opens its own copy of the document and works at most `prefetch` pages
+// ahead of the consumer, so memory stays bounded however long the document is.
+Napi::Object NewPageStream(Napi::Env env, DocumentSource source, PageStreamOptions options);
+
+#endif // PAGE_STREAM_H
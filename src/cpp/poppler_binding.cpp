@@ -1,16 +1,35 @@
 // src/cpp/poppler_binding.cpp
 #include <napi.h>
+#include "addon_data.h"
+#include "batch.h"
 #include "document.h"
 #include "page.h"
+#include "result_stream.h"
+#include "search_index.h"
+#include "stats.h"
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  // Every env (the main thread and each worker_thread) gets its own
+  // constructors; nothing below may be kept in a static
+  AddonData::Init(env);
+  
   // Initialize Document class
   Document::Init(env, exports);
   
   // Initialize Page class
   Page::Init(env, exports);
   
+  // Initialize ResultStream class (returned by pages() and processBatch())
+  ResultStream::Init(env, exports);
+  
+  // Initialize SearchIndex class
+  SearchIndex::Init(env, exports);
+  
   // Add utility functions
+  exports.Set("processBatch", Napi::Function::New(env, ProcessBatch, "processBatch"));
+  exports.Set("getStats", Napi::Function::New(env, GetStats, "getStats"));
+  exports.Set("resetStats", Napi::Function::New(env, ResetStats, "resetStats"));
+  exports.Set("observeStats", Napi::Function::New(env, ObserveStats, "observeStats"));
   exports.Set("version", Napi::String::New(env, "0.0.0"));
   
   return exports;
@@ -0,0 +1,394 @@
+// src/cpp/render.cpp
+#include "render.h"
+#include "stats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+bool isCompressed(ImageEncoding encoding) {
+  return ImageEncodingBytesPerPixel(encoding) == 0;
+}
+
+// True when poppler's bitmap already is the requested output, byte for
+// byte, so it can be handed over without conversion
+bool isNative(const RenderOutput& output) {
+  if (output.encoding == ImageEncoding::ARGB32) {
+    return true;
+  }
+  return !isCompressed(output.encoding) &&
+         output.image.format() == ImageEncodingRenderFormat(output.encoding) &&
+         output.image.bytes_per_row() == output.image.width() * ImageEncodingBytesPerPixel(output.encoding);
+}
+
+int bytesPerRow(const RenderOutput& output) {
+  if (output.encoding == ImageEncoding::ARGB32) {
+    return output.image.bytes_per_row();
+  }
+  // Raw encodings are tightly packed; compressed ones have no rows
+  return output.image.width() * ImageEncodingBytesPerPixel(output.encoding);
+}
+
+struct RenderProfile {
+  const char* name;
+  double dpi;
+  int hints;
+};
+
+const int kAllHints = poppler::page_renderer::antialiasing | poppler::page_renderer::text_antialiasing |
+                      poppler::page_renderer::text_hinting;
+
+// Thumbnails skip antialiasing entirely; at their size it costs more than
+// it shows
+const RenderProfile kProfiles[] = {
+  { "thumbnail", 36.0, 0 },
+  { "preview", 96.0, poppler::page_renderer::antialiasing | poppler::page_renderer::text_antialiasing |
+                     poppler::page_renderer::text_hinting },
+  { "print", 300.0, poppler::page_renderer::antialiasing | poppler::page_renderer::text_antialiasing },
+};
+
+void setHint(RenderOptions* options, poppler::page_renderer::render_hint hint, bool enabled) {
+  options->hintMask |= hint;
+  options->hints = enabled ? (options->hints | hint) : (options->hints & ~hint);
+}
+
+// Puts a renderer's settings back however the render ends
+class RendererSettingsGuard {
+public:
+  explicit RendererSettingsGuard(poppler::page_renderer& renderer)
+      : renderer_(renderer), hints_(renderer.render_hints()), format_(renderer.image_format()) {}
+  ~RendererSettingsGuard() {
+    renderer_.set_render_hints(hints_);
+    renderer_.set_image_format(format_);
+  }
+
+private:
+  poppler::page_renderer& renderer_;
+  int hints_;
+  poppler::image::format_enum format_;
+};
+
+// Page size in points as it comes out of the renderer, after the page's
+// own orientation and the requested rotation
+void orientedSize(const poppler::page* page, const RenderOptions& options, double* width, double* height) {
+  poppler::rectf rect = page->page_rect();
+  *width = rect.width();
+  *height = rect.height();
+  
+  // landscape and seascape pages are turned a quarter; so are odd rotations
+  poppler::page::orientation_enum orientation = page->orientation();
+  bool pageTurned = orientation == poppler::page::landscape || orientation == poppler::page::seascape;
+  if (pageTurned != (options.rotation % 2 == 1)) {
+    std::swap(*width, *height);
+  }
+}
+
+// Resolution at which the page fills the fit box along its tighter side
+double fitDpi(const poppler::page* page, const RenderOptions& options) {
+  double width;
+  double height;
+  orientedSize(page, options, &width, &height);
+  
+  double scale = 0.0;
+  if (options.fitWidth > 0 && width > 0) {
+    scale = options.fitWidth / width;
+  }
+  if (options.fitHeight > 0 && height > 0) {
+    double heightScale = options.fitHeight / height;
+    scale = scale > 0.0 ? std::min(scale, heightScale) : heightScale;
+  }
+  if (scale <= 0.0) {
+    return options.dpi;
+  }
+  // Nudged down so rounding up to whole pixels cannot overflow the box
+  return scale * 72.0 * (1.0 - 1e-9);
+}
+
+double renderDpi(const poppler::page* page, const RenderOptions& options) {
+  return options.fitWidth > 0 || options.fitHeight > 0 ? fitDpi(page, options) : options.dpi;
+}
+
+// The requested region cut to the page's pixel bounds at `dpi`; the whole
+// page when no region was given. Throws if the region misses the page.
+RenderRegion clampedRegion(const poppler::page* page, const RenderOptions& options, double dpi) {
+  if (options.region.width <= 0 || options.region.height <= 0) {
+    return options.region;
+  }
+  
+  double width;
+  double height;
+  orientedSize(page, options, &width, &height);
+  double pageWidth = std::ceil(width * dpi / 72.0);
+  double pageHeight = std::ceil(height * dpi / 72.0);
+  
+  RenderRegion region = options.region;
+  if (region.x >= pageWidth || region.y >= pageHeight) {
+    throw std::runtime_error("Region lies outside the page (" + std::to_string(static_cast<long long>(pageWidth)) +
+                             "x" + std::to_string(static_cast<long long>(pageHeight)) + " pixels)");
+  }
+  region.width = static_cast<int>(std::min<double>(region.width, pageWidth - region.x));
+  region.height = static_cast<int>(std::min<double>(region.height, pageHeight - region.y));
+  return region;
+}
+
+// Reads one of a region's fields, which must be a whole number of pixels
+bool regionField(Napi::Object region, const char* name, bool allowZero, int* target) {
+  Napi::Value value = region.Get(name);
+  double number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+  if (!(number >= (allowZero ? 0 : 1)) || number != std::floor(number) ||
+      number > std::numeric_limits<int>::max()) {
+    return false;
+  }
+  *target = static_cast<int>(number);
+  return true;
+}
+
+void setImageInfo(Napi::Env env, Napi::Object result, const RenderOutput& output) {
+  result.Set("width", Napi::Number::New(env, output.image.width()));
+  result.Set("height", Napi::Number::New(env, output.image.height()));
+  result.Set("bytesPerRow", Napi::Number::New(env, bytesPerRow(output)));
+  result.Set("format", Napi::String::New(env, ImageEncodingFormat(output.encoding)));
+}
+
+} // namespace
+
+bool ParseRenderOptions(Napi::Value value, RenderOptions* result) {
+  if (!value.IsObject()) {
+    return true;
+  }
+  
+  Napi::Env env = value.Env();
+  Napi::Object options = value.As<Napi::Object>();
+  
+  if (options.Has("profile")) {
+    std::string name = options.Get("profile").ToString().Utf8Value();
+    const RenderProfile* profile = nullptr;
+    for (const RenderProfile& candidate : kProfiles) {
+      if (name == candidate.name) {
+        profile = &candidate;
+      }
+    }
+    if (!profile) {
+      Napi::TypeError::New(env, "Unsupported profile: expected 'thumbnail', 'preview' or 'print'")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+    result->dpi = profile->dpi;
+    result->hintMask = kAllHints;
+    result->hints = profile->hints;
+  }
+  
+  if (options.Has("dpi")) {
+    result->dpi = options.Get("dpi").As<Napi::Number>().DoubleValue();
+  }
+  
+  if (options.Has("scale")) {
+    result->dpi = options.Get("scale").As<Napi::Number>().DoubleValue() * 72.0;
+  }
+  
+  if (options.Has("rotation")) {
+    result->rotation = options.Get("rotation").As<Napi::Number>().Int32Value();
+  }
+  
+  if (options.Has("encoding")) {
+    Napi::Value encoding = options.Get("encoding");
+    if (!encoding.IsString() ||
+        !ParseImageEncoding(encoding.As<Napi::String>().Utf8Value(), &result->encoding)) {
+      Napi::TypeError::New(env, "Unsupported encoding: expected 'argb32', 'rgba', 'rgb', 'gray', 'png' or 'jpeg'")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+  }
+  
+  if (options.Has("antialiasing")) {
+    setHint(result, poppler::page_renderer::antialiasing, options.Get("antialiasing").ToBoolean());
+  }
+  
+  if (options.Has("textAntialiasing")) {
+    setHint(result, poppler::page_renderer::text_antialiasing, options.Get("textAntialiasing").ToBoolean());
+  }
+  
+  if (options.Has("textHinting")) {
+    setHint(result, poppler::page_renderer::text_hinting, options.Get("textHinting").ToBoolean());
+  }
+  
+  if (options.Has("fit")) {
+    Napi::Value fitValue = options.Get("fit");
+    if (!fitValue.IsObject()) {
+      Napi::TypeError::New(env, "Expected fit to be an object").ThrowAsJavaScriptException();
+      return false;
+    }
+    
+    Napi::Object fit = fitValue.As<Napi::Object>();
+    result->fitWidth = fit.Has("width") ? fit.Get("width").ToNumber().Int32Value() : 0;
+    result->fitHeight = fit.Has("height") ? fit.Get("height").ToNumber().Int32Value() : 0;
+    
+    if (result->fitWidth < 0 || result->fitHeight < 0 || (result->fitWidth == 0 && result->fitHeight == 0)) {
+      Napi::RangeError::New(env, "Expected fit with a positive width and/or height").ThrowAsJavaScriptException();
+      return false;
+    }
+  }
+  
+  if (options.Has("region")) {
+    Napi::Value regionValue = options.Get("region");
+    RenderRegion region;
+    if (!regionValue.IsObject() ||
+        !regionField(regionValue.As<Napi::Object>(), "x", true, &region.x) ||
+        !regionField(regionValue.As<Napi::Object>(), "y", true, &region.y) ||
+        !regionField(regionValue.As<Napi::Object>(), "width", false, &region.width) ||
+        !regionField(regionValue.As<Napi::Object>(), "height", false, &region.height)) {
+      Napi::RangeError::New(env, "Expected region with whole-pixel x and y >= 0 and width and height >= 1")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+    result->region = region;
+  }
+  
+  if (options.Has("maxPixels")) {
+    Napi::Value maxPixels = options.Get("maxPixels");
+    if (!maxPixels.IsNumber() || maxPixels.As<Napi::Number>().DoubleValue() < 0) {
+      Napi::TypeError::New(env, "Expected maxPixels to be a non-negative number").ThrowAsJavaScriptException();
+      return false;
+    }
+    result->maxPixels = maxPixels.As<Napi::Number>().DoubleValue();
+  }
+  
+  return true;
+}
+
+poppler::image RenderPage(poppler::page_renderer& renderer, const poppler::page* page,
+                          const RenderOptions& options) {
+  if (options.maxPixels > 0) {
+    double pixels = RenderPixelCount(page, options);
+    if (pixels > options.maxPixels) {
+      throw std::runtime_error("Render of " + std::to_string(static_cast<long long>(pixels)) +
+                               " pixels exceeds maxPixels (" +
+                               std::to_string(static_cast<long long>(options.maxPixels)) + ")");
+    }
+  }
+  
+  RendererSettingsGuard guard(renderer);
+  renderer.set_render_hints((renderer.render_hints() & ~options.hintMask) | (options.hints & options.hintMask));
+  renderer.set_image_format(ImageEncodingRenderFormat(options.encoding));
+  
+  double dpi = renderDpi(page, options);
+  RenderRegion region = clampedRegion(page, options, dpi);
+  StatsTimer timer(Stats::Global().render, "render");
+  poppler::image image = renderer.render_page(page, dpi, dpi, region.x, region.y, region.width, region.height,
+                                              static_cast<poppler::rotation_enum>(options.rotation));
+  timer.SetPixels(static_cast<double>(image.width()) * image.height());
+  return image;
+}
+
+double RenderPixelCount(const poppler::page* page, const RenderOptions& options) {
+  double dpi = renderDpi(page, options);
+  if (options.region.width > 0 && options.region.height > 0) {
+    RenderRegion region = clampedRegion(page, options, dpi);
+    return static_cast<double>(region.width) * region.height;
+  }
+  
+  // Rotation does not change the area
+  poppler::rectf rect = page->page_rect();
+  return std::ceil(rect.width() * dpi / 72.0) * std::ceil(rect.height() * dpi / 72.0);
+}
+
+void EncodeRenderOutput(RenderOutput& output) {
+  if (isNative(output)) {
+    return;
+  }
+  
+  if (isCompressed(output.encoding)) {
+    output.encoded = CompressImage(output.image, output.encoding);
+    return;
+  }
+  
+  output.encoded.resize(RenderOutputByteLength(output));
+  ConvertPixels(output.image, output.encoding, output.encoded.data());
+}
+
+size_t RenderOutputByteLength(const RenderOutput& output) {
+  if (isCompressed(output.encoding)) {
+    return output.encoded.size();
+  }
+  return static_cast<size_t>(output.image.height()) * bytesPerRow(output);
+}
+
+Napi::Object RenderOutputToObject(Napi::Env env, RenderOutput& output) {
+  Napi::Buffer<char> buffer;
+  
+  if (isNative(output)) {
+    // poppler::image is implicitly shared, so this heap copy only takes a
+    // reference on the pixels. The Buffer's finalizer drops it again.
+    poppler::image* owned = new poppler::image(output.image);
+    char* pixels = const_cast<char*>(owned->const_data());
+    int64_t length = static_cast<int64_t>(RenderOutputByteLength(output));
+    // Bitmaps are the addon's largest allocations; without this V8 sees a
+    // few bytes per Buffer and collects them far too late
+    ReportExternalMemory(env, length);
+    buffer = Napi::Buffer<char>::New(
+        env, pixels, static_cast<size_t>(length),
+        [length](Napi::Env finalizeEnv, char*, poppler::image* hint) {
+          ReportExternalMemory(finalizeEnv, -length);
+          delete hint;
+        }, owned);
+  } else {
+    buffer = NewTrackedBuffer(env, std::move(output.encoded));
+  }
+  
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("data", buffer);
+  setImageInfo(env, result, output);
+  return result;
+}
+
+Napi::Object RenderOutputInfoToObject(Napi::Env env, const RenderOutput& output) {
+  Napi::Object result = Napi::Object::New(env);
+  setImageInfo(env, result, output);
+  result.Set("byteLength", Napi::Number::New(env, static_cast<double>(RenderOutputByteLength(output))));
+  return result;
+}
+
+bool WriteRenderOutput(RenderOutput& output, char* data, size_t length) {
+  if (isCompressed(output.encoding)) {
+    EncodeRenderOutput(output);
+    if (output.encoded.size() > length) {
+      return false;
+    }
+    std::memcpy(data, output.encoded.data(), output.encoded.size());
+    return true;
+  }
+  
+  if (RenderOutputByteLength(output) > length) {
+    return false;
+  }
+  
+  if (isNative(output)) {
+    std::memcpy(data, output.image.const_data(), RenderOutputByteLength(output));
+  } else {
+    ConvertPixels(output.image, output.encoding, data);
+  }
+  return true;
+}
+
+bool GetWritableBytes(Napi::Value value, char** data, size_t* length) {
+  if (value.IsTypedArray()) { // also covers Buffer
+    Napi::TypedArray array = value.As<Napi::TypedArray>();
+    *data = static_cast<char*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+    *length = array.ByteLength();
+    return true;
+  }
+  
+  if (value.IsArrayBuffer()) {
+    Napi::ArrayBuffer buffer = value.As<Napi::ArrayBuffer>();
+    *data = static_cast<char*>(buffer.Data());
+    *length = buffer.ByteLength();
+    return true;
+  }
+  
+  return false;
+}
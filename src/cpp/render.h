@@ -0,0 +1,92 @@
+// src/cpp/render.h
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <napi.h>
+#include <poppler/cpp/poppler-page.h>
+#include <poppler/cpp/poppler-image.h>
+#include <poppler/cpp/poppler-page-renderer.h>
+#include <cstddef>
+#include <vector>
+#include "encode.h"
+
+// Part of the page to rasterize, in output pixels at the render resolution.
+// The default (all -1) renders the whole page; a region reaching past the
+// page is cut to it.
+struct RenderRegion {
+  int x = -1;
+  int y = -1;
+  int width = -1;
+  int height = -1;
+};
+
+struct RenderOptions {
+  double dpi = 72.0;
+  int rotation = 0;
+  ImageEncoding encoding = ImageEncoding::ARGB32;
+  RenderRegion region;
+  // Render hints changed for this render only; bits outside `hintMask`
+  // keep the renderer's own setting
+  int hintMask = 0;
+  int hints = 0;
+  // Scale the page to fit inside this box instead of using `dpi`; 0 leaves
+  // that side unconstrained
+  int fitWidth = 0;
+  int fitHeight = 0;
+  // Refuse renders larger than this many pixels before allocating the
+  // bitmap; 0 means no limit. Not part of a tile's identity.
+  double maxPixels = 0;
+};
+
+// A rendered page in its requested encoding
+struct RenderOutput {
+  poppler::image image;        // the ARGB32 bitmap poppler rendered
+  std::vector<char> encoded;   // converted bytes, filled by EncodeRenderOutput
+  ImageEncoding encoding = ImageEncoding::ARGB32;
+};
+
+// Reads { profile, dpi, scale, rotation, encoding, region, fit, maxPixels,
+// antialiasing, textAntialiasing, textHinting } from a JS options object. The profile
+// ('thumbnail', 'preview' or 'print') sets the dpi and hints first, so
+// explicit options refine it; `scale` is dpi / 72 and wins over `dpi`.
+// Anything that is not an object yields defaults. Throws a JS exception
+// and returns false on invalid options.
+bool ParseRenderOptions(Napi::Value value, RenderOptions* options);
+
+// Renders with the options' hints, fit box and the bitmap format matching
+// its encoding, then restores the renderer's settings. Caller must hold the
+// owning document's mutex (which also guards `renderer`). Throws
+// std::runtime_error without rendering if the output would exceed maxPixels
+// or the region lies outside the page.
+poppler::image RenderPage(poppler::page_renderer& renderer, const poppler::page* page,
+                          const RenderOptions& options);
+
+// Pixels RenderPage() would produce for these options, computed from the
+// page size without rendering; used to refuse oversized renders up front
+double RenderPixelCount(const poppler::page* page, const RenderOptions& options);
+
+// Converts or compresses output.image into output.encoded. Does not touch
+// the document, so it should run after the document mutex is released.
+// Throws std::runtime_error if compression fails.
+void EncodeRenderOutput(RenderOutput& output);
+
+// Size of the data handed to JS (known up front for raw encodings)
+size_t RenderOutputByteLength(const RenderOutput& output);
+
+// Wraps the output in a { data, width, height, bytesPerRow, format } object.
+// `data` is an external Buffer over native memory that is released when the
+// Buffer is collected, so the pixels are never copied again.
+Napi::Object RenderOutputToObject(Napi::Env env, RenderOutput& output);
+
+// Same shape as RenderOutputToObject without `data`, plus `byteLength`
+Napi::Object RenderOutputInfoToObject(Napi::Env env, const RenderOutput& output);
+
+// Encodes the output straight into caller memory; raw encodings are written
+// without an intermediate buffer. Returns false if the memory is too small.
+// Throws std::runtime_error if compression fails.
+bool WriteRenderOutput(RenderOutput& output, char* data, size_t length);
+
+// Resolves the writable memory behind a Buffer, TypedArray or ArrayBuffer
+bool GetWritableBytes(Napi::Value value, char** data, size_t* length);
+
+#endif // RENDER_H
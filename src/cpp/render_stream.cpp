@@ -0,0 +1,99 @@
+// src/cpp/render_stream.cpp
+#include "render_stream.h"
+#include "result_stream.h"
+#include "stats.h"
+#include <poppler/cpp/poppler-page.h>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+class RenderItem : public StreamItem {
+public:
+  RenderItem(int index, size_t output) : index_(index), output_(output) {}
+  
+  RenderOutput image;
+  
+  Napi::Value ToValue(Napi::Env env) override {
+    Napi::Object value = Napi::Object::New(env);
+    value.Set("index", Napi::Number::New(env, index_));
+    value.Set("output", Napi::Number::New(env, static_cast<double>(output_)));
+    value.Set("image", RenderOutputToObject(env, image));
+    return value;
+  }
+
+private:
+  int index_;
+  size_t output_;
+};
+
+// Per-thread document and renderer, reused for every page the thread claims
+struct RenderWorker {
+  std::unique_ptr<poppler::document> doc;
+  poppler::page_renderer renderer;
+};
+
+void renderPage(const DocumentSource& source, const RenderStreamOptions& options, RenderWorker& worker,
+                int index, StreamEmitter& emitter) {
+  if (!worker.doc) {
+    worker.doc = source.Open();
+    if (!worker.doc) {
+      throw std::runtime_error("Failed to open document on worker thread");
+    }
+    worker.renderer.set_render_hints(options.renderHints);
+  }
+  
+  std::unique_ptr<poppler::page> page;
+  {
+    StatsTimer timer(Stats::Global().pageCreate, "pageCreate");
+    page.reset(worker.doc->create_page(index));
+  }
+  if (!page) {
+    throw std::runtime_error("Failed to create page " + std::to_string(index));
+  }
+  
+  for (size_t i = 0; i < options.outputs.size(); ++i) {
+    if (emitter.Cancelled()) {
+      return;
+    }
+    CheckCancelled(options.cancel);
+    
+    const RenderOptions& renderOptions = options.outputs[i];
+    auto item = std::make_unique<RenderItem>(index, i);
+    item->image.encoding = renderOptions.encoding;
+    item->image.image = RenderPage(worker.renderer, page.get(), renderOptions);
+    if (!item->image.image.is_valid()) {
+      throw std::runtime_error("Failed to render page " + std::to_string(index));
+    }
+    EncodeRenderOutput(item->image);
+    
+    // Never blocks: room for every output was reserved with the page
+    if (!emitter.Emit(std::move(item))) {
+      return;
+    }
+  }
+}
+
+} // namespace
+
+Napi::Object NewRenderStream(Napi::Env env, DocumentSource source, RenderStreamOptions options) {
+  auto shared = std::make_shared<const RenderStreamOptions>(std::move(options));
+  size_t concurrency = shared->concurrency;
+  
+  // A page starts only once all its outputs have room, so at most one
+  // page's images wait per worker and pool threads never wait on JS
+  size_t itemsPerPage = shared->outputs.size();
+  return ResultStream::NewInstance(env, concurrency * itemsPerPage, "Error rendering pages",
+      [source = std::move(source), shared, concurrency, itemsPerPage](StreamSink& sink) {
+        const RenderStreamOptions& options = *shared;
+        std::vector<RenderWorker> workers(concurrency);
+        // Workers claim whole pages, so a page is only ever parsed once
+        sink.ParallelFor(options.pages.size(), concurrency, itemsPerPage,
+                         [&](size_t worker, size_t index, StreamEmitter& emitter) {
+          if (emitter.Cancelled()) {
+            return;
+          }
+          renderPage(source, options, workers[worker], options.pages[index], emitter);
+        });
+      });
+}
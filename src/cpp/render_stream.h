@@ -0,0 +1,28 @@
+// src/cpp/render_stream.h
+#ifndef RENDER_STREAM_H
+#define RENDER_STREAM_H
+
+#include <napi.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "cancel.h"
+#include "document_handle.h"
+#include "render.h"
+
+struct RenderStreamOptions {
+  std::vector<int> pages;
+  std::vector<RenderOptions> outputs; // rendered for every page, in order
+  int renderHints = 0;
+  size_t concurrency = 1;
+  std::shared_ptr<const CancelToken> cancel; // ends the stream with an error
+};
+
+// Renders several outputs of each page as a ResultStream. Pages are spread
+// over the worker pool; the worker that claims a page parses it once and
+// renders every output from it with its own document copy and renderer, so
+// fonts and page content are loaded once rather than once per output. Each
+// output is yielded as soon as it is encoded.
+Napi::Object NewRenderStream(Napi::Env env, DocumentSource source, RenderStreamOptions options);
+
+#endif // RENDER_STREAM_H
@@ -0,0 +1,341 @@
+// src/cpp/result_stream.cpp
+#include "result_stream.h"
+#include "addon_data.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+struct ResultStreamState {
+  size_t capacity;
+  std::string errorContext;
+  
+  // Shared with producer threads
+  std::mutex mutex;
+  std::condition_variable space;
+  std::deque<std::unique_ptr<StreamItem>> ready;
+  // Room promised to running ParallelFor tasks, counted against capacity
+  size_t reserved = 0;
+  std::thread::id producer;
+  bool finished = false;
+  bool cancelled = false;
+  std::string error;
+  
+  // JS thread only. `wake` runs Drain() on the JS thread; it is referenced
+  // only while next() calls are waiting.
+  Napi::ThreadSafeFunction wake;
+  bool wakeClosed = false;
+  bool referenced = false;
+  std::vector<Napi::Promise::Deferred> waiting;
+  
+  void Cancel() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      cancelled = true;
+      ready.clear();
+    }
+    space.notify_all();
+  }
+};
+
+namespace {
+
+Napi::Object iteratorResult(Napi::Env env, Napi::Value value, bool done) {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("value", value);
+  result.Set("done", Napi::Boolean::New(env, done));
+  return result;
+}
+
+// Settles as many waiting next() calls as the stream allows, in order
+void drain(Napi::Env env, ResultStreamState& state) {
+  Napi::HandleScope scope(env);
+  
+  while (!state.waiting.empty()) {
+    std::unique_ptr<StreamItem> item;
+    bool done;
+    std::string error;
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      if (!state.ready.empty()) {
+        item = std::move(state.ready.front());
+        state.ready.pop_front();
+      } else if (!state.finished && !state.cancelled) {
+        break;
+      }
+      done = !item;
+      if (done && !state.error.empty()) {
+        // Reported once; later calls just see the end of the stream
+        error = std::move(state.error);
+        state.error.clear();
+      }
+    }
+    state.space.notify_all();
+    
+    Napi::Promise::Deferred deferred = state.waiting.front();
+    state.waiting.erase(state.waiting.begin());
+    
+    if (!error.empty()) {
+      deferred.Reject(Napi::Error::New(env, error).Value());
+    } else if (done) {
+      deferred.Resolve(iteratorResult(env, env.Undefined(), true));
+    } else {
+      Napi::Value value = item->ToValue(env);
+      if (env.IsExceptionPending()) {
+        deferred.Reject(env.GetAndClearPendingException().Value());
+      } else {
+        deferred.Resolve(iteratorResult(env, value, false));
+      }
+    }
+  }
+  
+  bool wantRef = !state.waiting.empty();
+  if (!state.wakeClosed && wantRef != state.referenced) {
+    if (wantRef) {
+      state.wake.Ref(env);
+    } else {
+      state.wake.Unref(env);
+    }
+    state.referenced = wantRef;
+  }
+}
+
+// Queued calls can still arrive without an env while the addon unloads
+std::function<void(Napi::Env, Napi::Function)> wakeCallback(std::shared_ptr<ResultStreamState> state) {
+  return [state](Napi::Env env, Napi::Function) {
+    if (env != nullptr) {
+      drain(env, *state);
+    }
+  };
+}
+
+void runProducer(std::shared_ptr<ResultStreamState> state, ResultStream::Producer producer) {
+  StreamSink sink(state);
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->producer = std::this_thread::get_id();
+  }
+  
+  try {
+    producer(sink);
+  } catch (const std::exception& e) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->error = state->errorContext + ": " + e.what();
+  }
+  
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->finished = true;
+  }
+  
+  Napi::ThreadSafeFunction wake = state->wake;
+  wake.NonBlockingCall(wakeCallback(state));
+  wake.Release();
+}
+
+// Bookkeeping for one StreamSink::ParallelFor call; guarded by the
+// stream's mutex
+struct StreamTasks {
+  std::vector<size_t> freeWorkers;
+  size_t running = 0;
+  std::exception_ptr error;
+};
+
+} // namespace
+
+bool StreamEmitter::Emit(std::unique_ptr<StreamItem> item) {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->cancelled) {
+      return false;
+    }
+    state_->ready.push_back(std::move(item));
+    if (reserved_ > 0) {
+      --reserved_;
+      --state_->reserved;
+    }
+  }
+  
+  std::shared_ptr<ResultStreamState> state = state_;
+  state_->wake.NonBlockingCall(wakeCallback(state));
+  return true;
+}
+
+bool StreamEmitter::Cancelled() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->cancelled;
+}
+
+bool StreamSink::Push(std::unique_ptr<StreamItem> item) {
+  {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    if (std::this_thread::get_id() != state_->producer) {
+      // Waiting here on a pool thread would tie it up until JS reads on
+      throw std::logic_error("StreamSink::Push called off the producer thread");
+    }
+    state_->space.wait(lock, [this] {
+      return state_->cancelled || state_->ready.size() + state_->reserved < state_->capacity;
+    });
+    if (state_->cancelled) {
+      return false;
+    }
+    state_->ready.push_back(std::move(item));
+  }
+  
+  std::shared_ptr<ResultStreamState> state = state_;
+  state_->wake.NonBlockingCall(wakeCallback(state));
+  return true;
+}
+
+bool StreamSink::Cancelled() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->cancelled;
+}
+
+void StreamSink::ParallelFor(size_t count, size_t concurrency, size_t itemsPerTask, const Task& task) {
+  concurrency = std::max<size_t>(1, std::min(concurrency, count));
+  std::shared_ptr<ResultStreamState> state = state_;
+  auto tasks = std::make_shared<StreamTasks>();
+  for (size_t worker = concurrency; worker > 0; --worker) {
+    tasks->freeWorkers.push_back(worker - 1);
+  }
+  
+  auto canStart = [&state, &tasks, itemsPerTask]() {
+    if (tasks->freeWorkers.empty()) {
+      return false;
+    }
+    // A task that needs more than the whole buffer still runs, alone
+    size_t held = state->ready.size() + state->reserved;
+    return held == 0 || held + itemsPerTask <= state->capacity;
+  };
+  
+  for (size_t index = 0; index < count; ++index) {
+    size_t worker;
+    {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      // The producer thread is the one place that waits for the consumer
+      state->space.wait(lock, [&] { return state->cancelled || tasks->error || canStart(); });
+      if (state->cancelled || tasks->error) {
+        break;
+      }
+      worker = tasks->freeWorkers.back();
+      tasks->freeWorkers.pop_back();
+      ++tasks->running;
+      state->reserved += itemsPerTask;
+    }
+    
+    auto run = [state, tasks, &task, worker, index, itemsPerTask]() {
+      StreamEmitter emitter(state, itemsPerTask);
+      std::exception_ptr error;
+      try {
+        task(worker, index, emitter);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        // Room the task did not use goes back to the buffer
+        state->reserved -= emitter.reserved_;
+        tasks->freeWorkers.push_back(worker);
+        --tasks->running;
+        if (error && !tasks->error) {
+          tasks->error = error;
+        }
+      }
+      state->space.notify_all();
+    };
+    if (!WorkerPool::Shared().TrySubmit(run)) {
+      // The pool's queue is full: do the work here instead
+      run();
+    }
+  }
+  
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->space.wait(lock, [&tasks] { return tasks->running == 0; });
+  if (tasks->error) {
+    std::rethrow_exception(tasks->error);
+  }
+}
+
+Napi::Object ResultStream::Init(Napi::Env env, Napi::Object exports) {
+  Napi::HandleScope scope(env);
+  
+  Napi::Function func = DefineClass(env, "ResultStream", {
+    InstanceMethod("next", &ResultStream::Next),
+    InstanceMethod("return", &ResultStream::Return),
+    InstanceMethod(Napi::Symbol::WellKnown(env, "asyncIterator"), &ResultStream::Iterator)
+  });
+  
+  AddonData::Get(env)->resultStreamConstructor = Napi::Persistent(func);
+  
+  exports.Set("ResultStream", func);
+  return exports;
+}
+
+Napi::Object ResultStream::NewInstance(Napi::Env env, size_t capacity, std::string errorContext,
+                                       Producer producer) {
+  Napi::Object instance = AddonData::Get(env)->resultStreamConstructor.New({});
+  ResultStream* stream = Napi::ObjectWrap<ResultStream>::Unwrap(instance);
+  
+  auto state = std::make_shared<ResultStreamState>();
+  state->capacity = capacity > 0 ? capacity : 1;
+  state->errorContext = std::move(errorContext);
+  state->wake = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+      "poppler:ResultStream", 0, 1,
+      [state](Napi::Env) { state->wakeClosed = true; });
+  state->wake.Unref(env);
+  stream->state_ = state;
+  
+  // The producer owns a reference to the state, so it can finish (or
+  // notice cancellation) after the stream object is gone
+  std::thread(runProducer, state, std::move(producer)).detach();
+  
+  return instance;
+}
+
+ResultStream::ResultStream(const Napi::CallbackInfo& info) : Napi::ObjectWrap<ResultStream>(info) {
+  // Private constructor - streams are created by the methods that fill them
+}
+
+ResultStream::~ResultStream() {
+  if (state_) {
+    state_->Cancel();
+  }
+}
+
+Napi::Value ResultStream::Next(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!state_) {
+    Napi::Error::New(env, "Result stream not initialized").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  state_->waiting.push_back(deferred);
+  drain(env, *state_);
+  return deferred.Promise();
+}
+
+Napi::Value ResultStream::Return(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (state_) {
+    state_->Cancel();
+    drain(env, *state_);
+  }
+  
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  deferred.Resolve(iteratorResult(env, info[0], true));
+  return deferred.Promise();
+}
+
+Napi::Value ResultStream::Iterator(const Napi::CallbackInfo& info) {
+  return info.This();
+}
@@ -0,0 +1,98 @@
+// src/cpp/result_stream.h
+#ifndef RESULT_STREAM_H
+#define RESULT_STREAM_H
+
+#include <napi.h>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+// One result handed from native producers to JS. ToValue() runs on the JS
+// thread when the result is consumed.
+class StreamItem {
+public:
+  virtual ~StreamItem() = default;
+  virtual Napi::Value ToValue(Napi::Env env) = 0;
+};
+
+struct ResultStreamState;
+
+// Hands results from a StreamSink::ParallelFor task to the stream. Never
+// blocks: room for the task's items was reserved before it started.
+class StreamEmitter {
+public:
+  // Queues a result. Returns false, dropping the item, once the consumer
+  // has cancelled the stream.
+  bool Emit(std::unique_ptr<StreamItem> item);
+
+  // True once the consumer has called return() or dropped the stream
+  bool Cancelled() const;
+
+private:
+  friend class StreamSink;
+  StreamEmitter(std::shared_ptr<ResultStreamState> state, size_t reserved)
+      : state_(std::move(state)), reserved_(reserved) {}
+
+  std::shared_ptr<ResultStreamState> state_;
+  size_t reserved_; // items this task may still emit against its reservation
+};
+
+// Producer side of a ResultStream. Only the stream's own producer thread
+// may wait for the consumer; work fanned out to the shared worker pool goes
+// through ParallelFor() so pool threads never block on JS.
+class StreamSink {
+public:
+  using Task = std::function<void(size_t worker, size_t index, StreamEmitter& emitter)>;
+
+  explicit StreamSink(std::shared_ptr<ResultStreamState> state) : state_(std::move(state)) {}
+
+  // Queues a result, blocking while the stream's buffer is full. Returns
+  // false, dropping the item, once the consumer has cancelled the stream.
+  // Must be called on the producer thread.
+  bool Push(std::unique_ptr<StreamItem> item);
+
+  // True once the consumer has called return() or dropped the stream
+  bool Cancelled() const;
+
+  // Calls task(worker, index, emitter) for every index in [0, count) on up
+  // to `concurrency` pool threads, each emitting at most `itemsPerTask`
+  // results. A task only starts once the buffer has room for everything it
+  // may emit, so the producer thread is the only one that waits when the
+  // consumer falls behind. `worker` is a stable id in [0, concurrency), as
+  // with ::ParallelFor. Stops starting tasks once the stream is cancelled,
+  // and rethrows the first exception a task throws once the rest are done.
+  void ParallelFor(size_t count, size_t concurrency, size_t itemsPerTask, const Task& task);
+
+private:
+  std::shared_ptr<ResultStreamState> state_;
+};
+
+// Async iterator over results produced natively. The producer runs on its
+// own thread and may fan out to the worker pool; at most `capacity` results
+// wait for the consumer (or are reserved by running tasks), so a slow
+// consumer pauses the producer rather than growing memory. The event loop is only kept alive while a next() call is
+// pending, so an abandoned stream does not hold the process open.
+class ResultStream : public Napi::ObjectWrap<ResultStream> {
+public:
+  // Runs on the producer thread. Anything it throws rejects the pending
+  // next() call, prefixed with the stream's error context.
+  using Producer = std::function<void(StreamSink& sink)>;
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  static Napi::Object NewInstance(Napi::Env env, size_t capacity, std::string errorContext,
+                                  Producer producer);
+  
+  ResultStream(const Napi::CallbackInfo& info);
+  ~ResultStream();
+  
+  // Async iterator protocol
+  Napi::Value Next(const Napi::CallbackInfo& info);
+  Napi::Value Return(const Napi::CallbackInfo& info);
+  Napi::Value Iterator(const Napi::CallbackInfo& info);
+
+private:
+  std::shared_ptr<ResultStreamState> state_;
+};
+
+#endif // RESULT_STREAM_H
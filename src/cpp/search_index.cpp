@@ -0,0 +1,126 @@
+// src/cpp/search_index.cpp
+#include "search_index.h"
+#include "addon_data.h"
+#include "stats.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+Napi::Object SearchIndex::Init(Napi::Env env, Napi::Object exports) {
+  Napi::HandleScope scope(env);
+  
+  Napi::Function func = DefineClass(env, "SearchIndex", {
+    StaticMethod("deserialize", &SearchIndex::Deserialize),
+    InstanceMethod("search", &SearchIndex::Search),
+    InstanceMethod("serialize", &SearchIndex::Serialize),
+    InstanceMethod("getPageCount", &SearchIndex::GetPageCount)
+  });
+  
+  AddonData::Get(env)->searchIndexConstructor = Napi::Persistent(func);
+  
+  exports.Set("SearchIndex", func);
+  return exports;
+}
+
+Napi::Object SearchIndex::NewInstance(Napi::Env env, std::shared_ptr<const TextIndex> index) {
+  Napi::Object instance = AddonData::Get(env)->searchIndexConstructor.New({});
+  SearchIndex* wrapper = Napi::ObjectWrap<SearchIndex>::Unwrap(instance);
+  wrapper->index_ = std::move(index);
+  return instance;
+}
+
+SearchIndex::SearchIndex(const Napi::CallbackInfo& info) : Napi::ObjectWrap<SearchIndex>(info) {
+  // Private constructor - use Document.buildSearchIndex() or SearchIndex.deserialize()
+}
+
+Napi::Value SearchIndex::Deserialize(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (info.Length() < 1 || !info[0].IsBuffer()) {
+    Napi::TypeError::New(env, "Expected buffer").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  Napi::Buffer<char> buffer = info[0].As<Napi::Buffer<char>>();
+  
+  try {
+    std::shared_ptr<TextIndex> index = std::make_shared<TextIndex>();
+    if (!TextIndex::Deserialize(buffer.Data(), buffer.Length(), index.get())) {
+      Napi::Error::New(env, "Invalid or incompatible search index").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    return NewInstance(env, index);
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, std::string("Error loading search index: ") + e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value SearchIndex::Search(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!index_) {
+    Napi::Error::New(env, "Search index not initialized").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected query string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  size_t limit = SIZE_MAX;
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+    if (options.Has("limit")) {
+      Napi::Value limitValue = options.Get("limit");
+      if (!limitValue.IsNumber() || limitValue.As<Napi::Number>().Int32Value() < 0) {
+        Napi::TypeError::New(env, "Expected limit to be a non-negative number").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      limit = limitValue.As<Napi::Number>().Uint32Value();
+    }
+  }
+  
+  std::vector<TextIndexHit> hits = index_->Search(info[0].As<Napi::String>().Utf8Value(), limit);
+  
+  Napi::Array result = Napi::Array::New(env, hits.size());
+  for (size_t i = 0; i < hits.size(); ++i) {
+    const TextIndexHit& hit = hits[i];
+    
+    Napi::Object bbox = Napi::Object::New(env);
+    bbox.Set("x", Napi::Number::New(env, hit.x0));
+    bbox.Set("y", Napi::Number::New(env, hit.y0));
+    bbox.Set("width", Napi::Number::New(env, hit.x1 - hit.x0));
+    bbox.Set("height", Napi::Number::New(env, hit.y1 - hit.y0));
+    
+    Napi::Object hitObj = Napi::Object::New(env);
+    hitObj.Set("page", Napi::Number::New(env, hit.page));
+    hitObj.Set("bbox", bbox);
+    result.Set(i, hitObj);
+  }
+  
+  return result;
+}
+
+Napi::Value SearchIndex::Serialize(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!index_) {
+    Napi::Error::New(env, "Search index not initialized").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  return NewTrackedBuffer(env, index_->Serialize());
+}
+
+Napi::Value SearchIndex::GetPageCount(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (!index_) {
+    Napi::Error::New(env, "Search index not initialized").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  return Napi::Number::New(env, index_->PageCount());
+}
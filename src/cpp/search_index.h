@@ -0,0 +1,30 @@
+// src/cpp/search_index.h
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <napi.h>
+#include <memory>
+#include "text_index.h"
+
+// JS handle on a built TextIndex. The index is immutable once built, so
+// searches need no locking and never touch the source document.
+class SearchIndex : public Napi::ObjectWrap<SearchIndex> {
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  static Napi::Object NewInstance(Napi::Env env, std::shared_ptr<const TextIndex> index);
+  
+  SearchIndex(const Napi::CallbackInfo& info);
+  
+  // Static methods
+  static Napi::Value Deserialize(const Napi::CallbackInfo& info);
+  
+  // Instance methods
+  Napi::Value Search(const Napi::CallbackInfo& info);
+  Napi::Value Serialize(const Napi::CallbackInfo& info);
+  Napi::Value GetPageCount(const Napi::CallbackInfo& info);
+
+private:
+  std::shared_ptr<const TextIndex> index_;
+};
+
+#endif // SEARCH_INDEX_H
@@ -0,0 +1,327 @@
+// src/cpp/stats.cpp
+#include "stats.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace {
+
+// min and max have no atomic fetch operation, so they retry until the
+// stored value is already at least as extreme
+void storeMin(std::atomic<double>& target, double value) {
+  double current = target.load(std::memory_order_relaxed);
+  while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+void storeMax(std::atomic<double>& target, double value) {
+  double current = target.load(std::memory_order_relaxed);
+  while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+// std::atomic<double>::fetch_add is C++20; the addon builds as C++17
+void addTo(std::atomic<double>& target, double value) {
+  double current = target.load(std::memory_order_relaxed);
+  while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+  }
+}
+
+int bucketFor(double value) {
+  double micros = value * 1000.0;
+  if (!(micros >= 1.0)) {
+    return 0;
+  }
+  int bucket = static_cast<int>(std::log2(micros)) + 1;
+  return bucket < StatsHistogram::kBuckets ? bucket : StatsHistogram::kBuckets - 1;
+}
+
+// Upper bound of a bucket, in the histogram's unit
+double bucketLimit(int bucket) {
+  return std::ldexp(1.0, bucket) / 1000.0;
+}
+
+// Observer set by observeStats(), one per env: each worker_thread may
+// observe the process-wide figures on its own. The function is unref'd, so
+// observing never keeps the process alive.
+struct StatsObserver {
+  napi_env env;
+  Napi::ThreadSafeFunction callback;
+  // steady_clock reading matching performance.now() == originMs
+  std::chrono::steady_clock::time_point origin;
+  double originMs = 0;
+};
+
+std::mutex observerMutex;
+std::vector<std::unique_ptr<StatsObserver>> observers;
+std::atomic<bool> observing{false};
+
+// Removes and releases the env's observer; observerMutex must be held
+void removeObserverLocked(napi_env env) {
+  for (auto it = observers.begin(); it != observers.end(); ++it) {
+    if ((*it)->env == env) {
+      (*it)->callback.Release();
+      observers.erase(it);
+      break;
+    }
+  }
+  observing.store(!observers.empty(), std::memory_order_relaxed);
+}
+
+// Env cleanup hook: a worker that exits while observing must stop
+// receiving events before its thread-safe function goes away
+void stopObserving(void* arg) {
+  std::lock_guard<std::mutex> lock(observerMutex);
+  removeObserverLocked(static_cast<StatsObserver*>(arg)->env);
+}
+
+struct StatsEvent {
+  const char* name;
+  double startTime;
+  double duration;
+  double pixels;
+};
+
+void emitEvent(const char* name, std::chrono::steady_clock::time_point start, double duration,
+               double pixels) {
+  // Held across the calls so observeStats() cannot release a function
+  // while it is in use; NonBlockingCall only queues
+  std::lock_guard<std::mutex> lock(observerMutex);
+  for (const std::unique_ptr<StatsObserver>& current : observers) {
+    double startTime = current->originMs +
+                       std::chrono::duration<double, std::milli>(start - current->origin).count();
+    StatsEvent* event = new StatsEvent{ name, startTime, duration, pixels };
+    napi_status status = current->callback.NonBlockingCall(event, [](Napi::Env env, Napi::Function fn, StatsEvent* data) {
+      std::unique_ptr<StatsEvent> owned(data);
+      if (env == nullptr) {
+        return;
+      }
+      
+      Napi::Object entry = Napi::Object::New(env);
+      entry.Set("name", Napi::String::New(env, owned->name));
+      entry.Set("entryType", Napi::String::New(env, "poppler"));
+      entry.Set("startTime", Napi::Number::New(env, owned->startTime));
+      entry.Set("duration", Napi::Number::New(env, owned->duration));
+      if (owned->pixels > 0) {
+        Napi::Object detail = Napi::Object::New(env);
+        detail.Set("pixels", Napi::Number::New(env, owned->pixels));
+        entry.Set("detail", detail);
+      }
+      fn.Call({ entry });
+    });
+    if (status != napi_ok) {
+      delete event;
+    }
+  }
+}
+
+} // namespace
+
+void StatsHistogram::Record(double value) {
+  if (count_.fetch_add(1, std::memory_order_relaxed) == 0) {
+    // First sample seeds min and max; a racing second sample still lands
+    // through the CAS loops below
+    min_.store(value, std::memory_order_relaxed);
+    max_.store(value, std::memory_order_relaxed);
+  }
+  addTo(sum_, value);
+  storeMin(min_, value);
+  storeMax(max_, value);
+  buckets_[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void StatsHistogram::Reset() {
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  min_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+Napi::Object StatsHistogram::ToObject(Napi::Env env) const {
+  uint64_t counts[kBuckets];
+  uint64_t total = 0;
+  for (int i = 0; i < kBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  double min = min_.load(std::memory_order_relaxed);
+  double max = max_.load(std::memory_order_relaxed);
+  double sum = sum_.load(std::memory_order_relaxed);
+  
+  // Percentiles report the upper bound of the bucket they fall in, clamped
+  // to the observed range
+  auto percentile = [&](double p) {
+    if (total == 0) {
+      return 0.0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(total * p));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return std::min(std::max(bucketLimit(i), min), max);
+      }
+    }
+    return max;
+  };
+  
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("count", Napi::Number::New(env, static_cast<double>(total)));
+  result.Set("sum", Napi::Number::New(env, sum));
+  result.Set("min", Napi::Number::New(env, min));
+  result.Set("max", Napi::Number::New(env, max));
+  result.Set("mean", Napi::Number::New(env, total > 0 ? sum / total : 0.0));
+  result.Set("p50", Napi::Number::New(env, percentile(0.5)));
+  result.Set("p90", Napi::Number::New(env, percentile(0.9)));
+  result.Set("p99", Napi::Number::New(env, percentile(0.99)));
+  return result;
+}
+
+Stats& Stats::Global() {
+  static Stats stats;
+  return stats;
+}
+
+void Stats::Reset() {
+  // Live counts and memory describe current state, so only the
+  // accumulated figures start over
+  load.Reset();
+  pageCreate.Reset();
+  textExtract.Reset();
+  render.Reset();
+  bytesCopied.store(0, std::memory_order_relaxed);
+}
+
+StatsTimer::~StatsTimer() {
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  double duration = std::chrono::duration<double, std::milli>(end - start_).count();
+  
+  if (pixels_ > 0) {
+    histogram_.Record(duration / (pixels_ / 1e6));
+  } else {
+    histogram_.Record(duration);
+  }
+  
+  if (observing.load(std::memory_order_relaxed)) {
+    emitEvent(name_, start_, duration, pixels_);
+  }
+}
+
+void ReportExternalMemory(Napi::Env env, int64_t change) {
+  if (change == 0) {
+    return;
+  }
+  Stats::Global().externalBytes.fetch_add(change, std::memory_order_relaxed);
+  Napi::MemoryManagement::AdjustExternalMemory(env, change);
+}
+
+namespace {
+
+template <typename Bytes>
+Napi::Buffer<char> newTrackedBuffer(Napi::Env env, Bytes bytes) {
+  Bytes* owned = new Bytes(std::move(bytes));
+  int64_t length = static_cast<int64_t>(owned->size());
+  ReportExternalMemory(env, length);
+  return Napi::Buffer<char>::New(
+      env, owned->data(), owned->size(),
+      [length](Napi::Env finalizeEnv, char*, Bytes* hint) {
+        ReportExternalMemory(finalizeEnv, -length);
+        delete hint;
+      }, owned);
+}
+
+} // namespace
+
+Napi::Buffer<char> NewTrackedBuffer(Napi::Env env, std::vector<char> bytes) {
+  return newTrackedBuffer(env, std::move(bytes));
+}
+
+Napi::Buffer<char> NewTrackedBuffer(Napi::Env env, std::string bytes) {
+  return newTrackedBuffer(env, std::move(bytes));
+}
+
+Napi::Value GetStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Stats& stats = Stats::Global();
+  
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("load", stats.load.ToObject(env));
+  result.Set("pageCreate", stats.pageCreate.ToObject(env));
+  result.Set("textExtract", stats.textExtract.ToObject(env));
+  result.Set("renderPerMegapixel", stats.render.ToObject(env));
+  result.Set("bytesCopied", Napi::Number::New(env, static_cast<double>(stats.bytesCopied.load())));
+  
+  Napi::Object documents = Napi::Object::New(env);
+  documents.Set("live", Napi::Number::New(env, static_cast<double>(stats.liveDocuments.load())));
+  documents.Set("nativeBytes", Napi::Number::New(env, static_cast<double>(stats.documentBytes.load())));
+  result.Set("documents", documents);
+  
+  Napi::Object pages = Napi::Object::New(env);
+  pages.Set("live", Napi::Number::New(env, static_cast<double>(stats.livePages.load())));
+  result.Set("pages", pages);
+  
+  result.Set("externalBytes", Napi::Number::New(env, static_cast<double>(stats.externalBytes.load())));
+  return result;
+}
+
+Napi::Value ResetStats(const Napi::CallbackInfo& info) {
+  Stats::Global().Reset();
+  return info.Env().Undefined();
+}
+
+Napi::Value ObserveStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  
+  if (info.Length() < 1 || !(info[0].IsFunction() || info[0].IsNull() || info[0].IsUndefined())) {
+    Napi::TypeError::New(env, "Expected a callback or null").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  
+  std::unique_ptr<StatsObserver> next;
+  if (info[0].IsFunction()) {
+    next = std::make_unique<StatsObserver>();
+    next->env = env;
+    next->callback = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(),
+                                                   "poppler:observeStats", 0, 1);
+    next->callback.Unref(env);
+    
+    // Line the native clock up with performance.now() so entries can be
+    // compared with the rest of the process's timeline
+    next->origin = std::chrono::steady_clock::now();
+    Napi::Value performance = env.Global().Get("performance");
+    if (performance.IsObject()) {
+      Napi::Value now = performance.As<Napi::Object>().Get("now");
+      if (now.IsFunction()) {
+        Napi::Value nowMs = now.As<Napi::Function>().Call(performance, {});
+        if (env.IsExceptionPending()) {
+          next->callback.Release();
+          return env.Null();
+        }
+        next->originMs = nowMs.ToNumber().DoubleValue();
+      }
+    }
+  }
+  
+  std::lock_guard<std::mutex> lock(observerMutex);
+  for (const std::unique_ptr<StatsObserver>& current : observers) {
+    if (current->env == env) {
+      napi_remove_env_cleanup_hook(env, stopObserving, current.get());
+      break;
+    }
+  }
+  removeObserverLocked(env);
+  if (next) {
+    // Added after the thread-safe function, so the hook runs before the
+    // function's own teardown (hooks run in reverse order)
+    napi_add_env_cleanup_hook(env, stopObserving, next.get());
+    observers.push_back(std::move(next));
+    observing.store(true, std::memory_order_relaxed);
+  }
+  
+  return env.Undefined();
+}
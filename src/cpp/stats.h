@@ -0,0 +1,91 @@
+// src/cpp/stats.h
+#ifndef STATS_H
+#define STATS_H
+
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Lock-free histogram of durations in milliseconds (or milliseconds per
+// megapixel for renders). Buckets are powers of two of a microsecond, so
+// percentiles are accurate to within a factor of two; count, sum, min and
+// max are exact.
+class StatsHistogram {
+public:
+  static const int kBuckets = 40;
+
+  void Record(double value);
+  void Reset();
+  Napi::Object ToObject(Napi::Env env) const;
+
+private:
+  std::atomic<uint64_t> count_{0};
+  std::atomic<double> sum_{0};
+  std::atomic<double> min_{0};
+  std::atomic<double> max_{0};
+  std::atomic<uint64_t> buckets_[kBuckets] = {};
+};
+
+// Process-wide counters behind getStats(). Updated from any thread.
+struct Stats {
+  static Stats& Global();
+
+  StatsHistogram load;          // opening a document, ms
+  StatsHistogram pageCreate;    // poppler::document::create_page, ms
+  StatsHistogram textExtract;   // text() / text_list() of one page, ms
+  StatsHistogram render;        // render_page, ms per megapixel
+
+  std::atomic<int64_t> bytesCopied{0};     // bytes copied into JS strings and Buffers
+  std::atomic<int64_t> liveDocuments{0};
+  std::atomic<int64_t> documentBytes{0};   // document bytes held in native memory
+  std::atomic<int64_t> livePages{0};
+  std::atomic<int64_t> externalBytes{0};   // reported to V8 through AdjustExternalMemory
+
+  void Reset();
+};
+
+// Times a scope into a histogram and, while an observer is set, emits a
+// perf_hooks-style entry named `name`. Safe on worker threads.
+class StatsTimer {
+public:
+  StatsTimer(StatsHistogram& histogram, const char* name)
+      : histogram_(histogram), name_(name), start_(std::chrono::steady_clock::now()) {}
+  ~StatsTimer();
+
+  StatsTimer(const StatsTimer&) = delete;
+  StatsTimer& operator=(const StatsTimer&) = delete;
+
+  // Records the value per megapixel instead of the raw duration
+  void SetPixels(double pixels) { pixels_ = pixels; }
+
+private:
+  StatsHistogram& histogram_;
+  const char* name_;
+  std::chrono::steady_clock::time_point start_;
+  double pixels_ = 0;
+};
+
+// Counts bytes copied out of native memory into a new JS value
+inline void CountCopiedToJs(size_t bytes) {
+  Stats::Global().bytesCopied.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+// Tells V8 about native memory kept alive by a JS object so the GC weighs
+// it; pass a negative change when the memory is released. JS thread only.
+void ReportExternalMemory(Napi::Env env, int64_t change);
+
+// Hands `bytes` to JS as a Buffer without copying them, reporting their
+// size to V8 until the Buffer is collected
+Napi::Buffer<char> NewTrackedBuffer(Napi::Env env, std::vector<char> bytes);
+Napi::Buffer<char> NewTrackedBuffer(Napi::Env env, std::string bytes);
+
+// getStats(), resetStats() and observeStats(callback | null)
+Napi::Value GetStats(const Napi::CallbackInfo& info);
+Napi::Value ResetStats(const Napi::CallbackInfo& info);
+Napi::Value ObserveStats(const Napi::CallbackInfo& info);
+
+#endif // STATS_H
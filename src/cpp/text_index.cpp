@@ -0,0 +1,252 @@
+// src/cpp/text_index.cpp
+#include "text_index.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char kMagic[4] = { 'P', 'S', 'I', 'X' };
+const uint32_t kVersion = 1;
+const uint32_t kByteOrderMark = 0x01020304;
+
+bool isAsciiPunct(unsigned char c) {
+  return c < 0x80 && !((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'));
+}
+
+template <typename T>
+void put(std::vector<char>& out, const T& value) {
+  const char* bytes = reinterpret_cast<const char*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// Bounds-checked reader over a serialized blob
+class Reader {
+public:
+  Reader(const char* data, size_t length) : data_(data), remaining_(length) {}
+
+  template <typename T>
+  bool Get(T* value) {
+    if (remaining_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(value, data_, sizeof(T));
+    data_ += sizeof(T);
+    remaining_ -= sizeof(T);
+    return true;
+  }
+
+  bool GetString(size_t length, std::string* value) {
+    if (remaining_ < length) {
+      return false;
+    }
+    value->assign(data_, length);
+    data_ += length;
+    remaining_ -= length;
+    return true;
+  }
+
+  size_t Remaining() const { return remaining_; }
+
+private:
+  const char* data_;
+  size_t remaining_;
+};
+
+} // namespace
+
+std::vector<std::string> TextIndex::Tokenize(const std::string& text) {
+  std::vector<std::string> terms;
+  size_t i = 0;
+  
+  while (i < text.size()) {
+    // Terms are separated by ASCII punctuation and whitespace
+    while (i < text.size() && isAsciiPunct(static_cast<unsigned char>(text[i]))) {
+      ++i;
+    }
+    size_t start = i;
+    while (i < text.size() && !isAsciiPunct(static_cast<unsigned char>(text[i]))) {
+      ++i;
+    }
+    if (i > start) {
+      std::string term = text.substr(start, i - start);
+      for (char& c : term) {
+        if (c >= 'A' && c <= 'Z') {
+          c = static_cast<char>(c - 'A' + 'a');
+        }
+      }
+      terms.push_back(std::move(term));
+    }
+  }
+  
+  return terms;
+}
+
+uint32_t TextIndex::Intern(const std::string& term) {
+  auto found = termIds_.find(term);
+  if (found != termIds_.end()) {
+    return found->second;
+  }
+  
+  uint32_t id = static_cast<uint32_t>(terms_.size());
+  terms_.push_back(term);
+  termIds_.emplace(term, id);
+  postings_.emplace_back();
+  return id;
+}
+
+void TextIndex::AddPage(const std::vector<IndexInputWord>& words) {
+  uint32_t page = pageCount_++;
+  
+  for (const IndexInputWord& word : words) {
+    // A box such as "e-mail" yields several terms sharing its bbox
+    for (const std::string& term : Tokenize(word.text)) {
+      uint32_t id = Intern(term);
+      postings_[id].push_back(static_cast<uint32_t>(words_.size()));
+      words_.push_back({ page, id, word.x, word.y, word.width, word.height });
+    }
+  }
+}
+
+std::vector<TextIndexHit> TextIndex::Search(const std::string& query, size_t limit) const {
+  std::vector<TextIndexHit> hits;
+  std::vector<std::string> queryTerms = Tokenize(query);
+  if (queryTerms.empty()) {
+    return hits;
+  }
+  
+  std::vector<uint32_t> ids;
+  ids.reserve(queryTerms.size());
+  for (const std::string& term : queryTerms) {
+    auto found = termIds_.find(term);
+    if (found == termIds_.end()) {
+      return hits;
+    }
+    ids.push_back(found->second);
+  }
+  
+  for (uint32_t start : postings_[ids[0]]) {
+    if (hits.size() >= limit) {
+      break;
+    }
+    if (start + ids.size() > words_.size()) {
+      break;
+    }
+    
+    const Word& first = words_[start];
+    bool match = true;
+    for (size_t i = 1; i < ids.size() && match; ++i) {
+      const Word& next = words_[start + i];
+      match = next.term == ids[i] && next.page == first.page;
+    }
+    if (!match) {
+      continue;
+    }
+    
+    TextIndexHit hit{ first.page, first.x, first.y, first.x + first.width, first.y + first.height };
+    for (size_t i = 1; i < ids.size(); ++i) {
+      const Word& word = words_[start + i];
+      hit.x0 = std::min(hit.x0, word.x);
+      hit.y0 = std::min(hit.y0, word.y);
+      hit.x1 = std::max(hit.x1, word.x + word.width);
+      hit.y1 = std::max(hit.y1, word.y + word.height);
+    }
+    hits.push_back(hit);
+  }
+  
+  return hits;
+}
+
+std::vector<char> TextIndex::Serialize() const {
+  std::vector<char> out;
+  size_t termBytes = 0;
+  for (const std::string& term : terms_) {
+    termBytes += sizeof(uint32_t) + term.size();
+  }
+  out.reserve(sizeof(kMagic) + 5 * sizeof(uint32_t) + termBytes + words_.size() * sizeof(Word));
+  
+  out.insert(out.end(), kMagic, kMagic + sizeof(kMagic));
+  put(out, kVersion);
+  put(out, kByteOrderMark);
+  put(out, pageCount_);
+  put(out, static_cast<uint32_t>(terms_.size()));
+  put(out, static_cast<uint32_t>(words_.size()));
+  
+  for (const std::string& term : terms_) {
+    put(out, static_cast<uint32_t>(term.size()));
+    out.insert(out.end(), term.begin(), term.end());
+  }
+  
+  for (const Word& word : words_) {
+    put(out, word.page);
+    put(out, word.term);
+    put(out, word.x);
+    put(out, word.y);
+    put(out, word.width);
+    put(out, word.height);
+  }
+  
+  return out;
+}
+
+bool TextIndex::Deserialize(const char* data, size_t length, TextIndex* index) {
+  Reader reader(data, length);
+  char magic[sizeof(kMagic)];
+  uint32_t version, byteOrder, pageCount, termCount, wordCount;
+  
+  for (char& c : magic) {
+    if (!reader.Get(&c)) {
+      return false;
+    }
+  }
+  if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !reader.Get(&version) || version != kVersion ||
+      !reader.Get(&byteOrder) || byteOrder != kByteOrderMark ||
+      !reader.Get(&pageCount) || !reader.Get(&termCount) || !reader.Get(&wordCount)) {
+    return false;
+  }
+  
+  // Each term takes at least its 4-byte length, so a count the input
+  // cannot hold is rejected before anything is allocated for it
+  if (termCount > reader.Remaining() / sizeof(uint32_t)) {
+    return false;
+  }
+  
+  TextIndex result;
+  result.pageCount_ = pageCount;
+  result.terms_.reserve(termCount);
+  result.postings_.resize(termCount);
+  for (uint32_t i = 0; i < termCount; ++i) {
+    uint32_t size;
+    std::string term;
+    if (!reader.Get(&size) || !reader.GetString(size, &term)) {
+      return false;
+    }
+    if (!result.termIds_.emplace(term, i).second) {
+      return false; // a repeated term would lose its postings
+    }
+    result.terms_.push_back(std::move(term));
+  }
+  
+  // Six 4-byte fields per word
+  if (reader.Remaining() / 24 < wordCount) {
+    return false;
+  }
+  result.words_.reserve(wordCount);
+  for (uint32_t i = 0; i < wordCount; ++i) {
+    Word word;
+    reader.Get(&word.page);
+    reader.Get(&word.term);
+    reader.Get(&word.x);
+    reader.Get(&word.y);
+    reader.Get(&word.width);
+    reader.Get(&word.height);
+    if (word.term >= termCount || word.page >= pageCount) {
+      return false;
+    }
+    result.postings_[word.term].push_back(i);
+    result.words_.push_back(word);
+  }
+  
+  *index = std::move(result);
+  return true;
+}
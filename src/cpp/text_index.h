@@ -0,0 +1,64 @@
+// src/cpp/text_index.h
+#ifndef TEXT_INDEX_H
+#define TEXT_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One word of a page as it goes into the index
+struct IndexInputWord {
+  std::string text; // UTF-8, as reported by poppler::text_box
+  float x, y, width, height;
+};
+
+struct TextIndexHit {
+  uint32_t page;
+  float x0, y0, x1, y1; // union of the matched words' boxes
+};
+
+// Inverted index from normalized terms to word positions. Words are stored
+// in reading order, so phrases are matched by checking the positions that
+// follow each occurrence of the first term. Terms are ASCII-lowercased with
+// leading and trailing ASCII punctuation removed; other bytes are kept
+// as-is.
+class TextIndex {
+public:
+  // Appends a page; pages must be added in order
+  void AddPage(const std::vector<IndexInputWord>& words);
+
+  // Every occurrence of the query's terms in sequence on one page
+  std::vector<TextIndexHit> Search(const std::string& query, size_t limit) const;
+
+  uint32_t PageCount() const { return pageCount_; }
+  size_t WordCount() const { return words_.size(); }
+  size_t TermCount() const { return terms_.size(); }
+
+  // Compact binary form: terms once, then one fixed-size record per word.
+  // Uses native byte order; Deserialize rejects blobs from the other kind
+  // of machine. Returns false on malformed input.
+  std::vector<char> Serialize() const;
+  static bool Deserialize(const char* data, size_t length, TextIndex* index);
+
+  // Splits text into normalized terms (empty pieces dropped)
+  static std::vector<std::string> Tokenize(const std::string& text);
+
+private:
+  struct Word {
+    uint32_t page;
+    uint32_t term;
+    float x, y, width, height;
+  };
+
+  uint32_t Intern(const std::string& term);
+
+  uint32_t pageCount_ = 0;
+  std::vector<std::string> terms_;
+  std::unordered_map<std::string, uint32_t> termIds_;
+  std::vector<Word> words_;
+  std::vector<std::vector<uint32_t>> postings_; // per term, ascending word positions
+};
+
+#endif // TEXT_INDEX_H
@@ -0,0 +1,105 @@
+// src/cpp/tile_cache.cpp
+#include "tile_cache.h"
+
+namespace {
+
+// A copy whose pixels are not shared with `output`
+RenderOutput detachedCopy(const RenderOutput& output) {
+  RenderOutput copy;
+  copy.image = output.image.copy();
+  copy.encoded = output.encoded;
+  copy.encoding = output.encoding;
+  return copy;
+}
+
+// Memory an entry holds: the bitmap is kept next to the encoded bytes
+// (it carries the tile's size), so both count against the capacity
+size_t retainedBytes(const RenderOutput& output) {
+  size_t bitmap = output.image.is_valid()
+                      ? static_cast<size_t>(output.image.bytes_per_row()) * output.image.height()
+                      : 0;
+  return bitmap + output.encoded.size();
+}
+
+} // namespace
+
+bool TileCache::Get(const TileKey& key, RenderOutput* tile) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    ++misses_;
+    return false;
+  }
+  
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, found->second);
+  *tile = detachedCopy(found->second->second);
+  return true;
+}
+
+void TileCache::Put(const TileKey& key, const RenderOutput& tile) {
+  // `tile` belongs to the caller, so it is copied before taking the lock;
+  // JS may write to the Buffer later made from it
+  size_t size = retainedBytes(tile);
+  if (size > Capacity()) {
+    return;
+  }
+  RenderOutput copy = detachedCopy(tile);
+  
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (size > capacity_ || index_.count(key) > 0) {
+    return;
+  }
+  
+  entries_.emplace_front(key, std::move(copy));
+  index_[key] = entries_.begin();
+  bytes_ += size;
+  Trim();
+}
+
+void TileCache::SetCapacity(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = bytes;
+  Trim();
+}
+
+void TileCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  bytes_ = 0;
+}
+
+size_t TileCache::Capacity() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return capacity_;
+}
+
+size_t TileCache::Bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+size_t TileCache::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+uint64_t TileCache::Hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+uint64_t TileCache::Misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+void TileCache::Trim() {
+  while (bytes_ > capacity_) {
+    bytes_ -= retainedBytes(entries_.back().second);
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
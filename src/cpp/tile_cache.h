@@ -0,0 +1,78 @@
+// src/cpp/tile_cache.h
+#ifndef TILE_CACHE_H
+#define TILE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include "render.h"
+
+// Identifies one rendered tile: the page, the zoom and the region, plus
+// everything else that changes the output bytes. `hints` are the ones the
+// tile is rendered with: the renderer's, as captured when its batch
+// started, with the options' overrides applied.
+struct TileKey {
+  int page;
+  double dpi;
+  int rotation;
+  ImageEncoding encoding;
+  RenderRegion region;
+  int hints;
+  int fitWidth, fitHeight;
+
+  TileKey(int pageIndex, int rendererHints, const RenderOptions& options)
+      : page(pageIndex), dpi(options.dpi), rotation(options.rotation),
+        encoding(options.encoding), region(options.region),
+        hints((rendererHints & ~options.hintMask) | (options.hints & options.hintMask)),
+        fitWidth(options.fitWidth), fitHeight(options.fitHeight) {}
+
+  bool operator<(const TileKey& other) const {
+    return std::tie(page, dpi, rotation, encoding, region.x, region.y, region.width, region.height,
+                    hints, fitWidth, fitHeight) <
+           std::tie(other.page, other.dpi, other.rotation, other.encoding,
+                    other.region.x, other.region.y, other.region.width, other.region.height,
+                    other.hints, other.fitWidth, other.fitHeight);
+  }
+};
+
+// LRU of rendered tiles bounded by the memory they hold, so a viewer can
+// pan back over tiles it has already seen without rendering them again.
+// Disabled (capacity 0) until setTileCacheSize() is called. Thread-safe:
+// tile batches look up and insert from worker threads. poppler::image
+// shares its pixels with a non-atomic reference count, so cached images
+// never leave the cache: tiles are copied in and out under its lock.
+class TileCache {
+public:
+  // Copies the cached tile into `tile`; false if there is none
+  bool Get(const TileKey& key, RenderOutput* tile);
+  void Put(const TileKey& key, const RenderOutput& tile);
+
+  void SetCapacity(size_t bytes);
+  void Clear();
+
+  size_t Capacity() const;
+  size_t Bytes() const;
+  size_t Size() const;
+  uint64_t Hits() const;
+  uint64_t Misses() const;
+
+private:
+  using Entry = std::pair<TileKey, RenderOutput>;
+
+  void Trim();
+
+  mutable std::mutex mutex_;
+  size_t capacity_ = 0;
+  size_t bytes_ = 0;
+  std::list<Entry> entries_; // most recently used first
+  std::map<TileKey, std::list<Entry>::iterator> index_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+#endif // TILE_CACHE_H
@@ -0,0 +1,142 @@
+// src/cpp/worker_pool.cpp
+#include "worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace {
+// Pending jobs allowed per thread before TrySubmit starts refusing work
+const size_t kQueuedJobsPerThread = 64;
+
+struct ParallelState {
+  ParallelState(size_t itemCount, const std::function<void(size_t, size_t)>* callback)
+      : count(itemCount), fn(callback) {}
+
+  std::atomic<size_t> next{0};
+  const size_t count;
+  const std::function<void(size_t, size_t)>* fn;
+
+  std::mutex mutex;
+  std::condition_variable idle;
+  size_t active = 0;
+  bool closed = false;
+  std::exception_ptr error;
+};
+
+void drain(ParallelState& state, size_t worker) {
+  for (;;) {
+    size_t index = state.next.fetch_add(1);
+    if (index >= state.count) {
+      return;
+    }
+    try {
+      (*state.fn)(worker, index);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      if (!state.error) {
+        state.error = std::current_exception();
+      }
+      state.next.store(state.count); // stop handing out work
+      return;
+    }
+  }
+}
+}
+
+WorkerPool& WorkerPool::Shared() {
+  // Intentionally leaked: joining threads from a static destructor at
+  // process exit can deadlock while Node is tearing down.
+  static WorkerPool* pool = [] {
+    size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    return new WorkerPool(threads, threads * kQueuedJobsPerThread);
+  }();
+  return *pool;
+}
+
+WorkerPool::WorkerPool(size_t threads, size_t maxQueued) : maxQueued_(maxQueued) {
+  threads_.reserve(threads);
+  for (size_t i = 0; i < threads; ++i) {
+    threads_.emplace_back(&WorkerPool::Run, this);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+bool WorkerPool::TrySubmit(Job job) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || queue_.size() >= maxQueued_) {
+      return false;
+    }
+    queue_.push_back(std::move(job));
+  }
+  ready_.notify_one();
+  return true;
+}
+
+void WorkerPool::Run() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return; // stopping and drained
+      }
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    job();
+  }
+}
+
+void ParallelFor(size_t count, size_t concurrency,
+                 const std::function<void(size_t worker, size_t index)>& fn) {
+  if (count == 0) {
+    return;
+  }
+  concurrency = std::max<size_t>(1, std::min(concurrency, count));
+
+  // Shared so helpers that only get scheduled after we return can still
+  // see that the loop is closed
+  auto state = std::make_shared<ParallelState>(count, &fn);
+
+  for (size_t worker = 1; worker < concurrency; ++worker) {
+    WorkerPool::Shared().TrySubmit([state, worker]() {
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->closed) {
+          return;
+        }
+        ++state->active;
+      }
+      drain(*state, worker);
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        --state->active;
+      }
+      state->idle.notify_all();
+    });
+    // A full queue just means fewer helpers; the caller still drains
+  }
+
+  drain(*state, 0);
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->closed = true;
+  state->idle.wait(lock, [&state] { return state->active == 0; });
+
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
@@ -0,0 +1,56 @@
+// src/cpp/worker_pool.h
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of native threads for work that must stay off the JS thread.
+// The queue is bounded so a burst of requests is rejected up front instead
+// of piling up bitmaps in memory.
+class WorkerPool {
+public:
+  using Job = std::function<void()>;
+
+  // Process-wide pool sized from the number of cores
+  static WorkerPool& Shared();
+
+  WorkerPool(size_t threads, size_t maxQueued);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Returns false without running the job when the queue is full
+  bool TrySubmit(Job job);
+
+  size_t Concurrency() const { return threads_.size(); }
+  size_t MaxQueued() const { return maxQueued_; }
+
+private:
+  void Run();
+
+  std::vector<std::thread> threads_;
+  std::deque<Job> queue_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  size_t maxQueued_;
+  bool stopping_ = false;
+};
+
+// Calls fn(worker, index) for every index in [0, count) using up to
+// `concurrency` workers: the calling thread plus helpers borrowed from the
+// shared pool. `worker` is a stable id in [0, concurrency) so callers can
+// keep per-worker state such as a private poppler::document. The calling
+// thread always makes progress itself, so this is safe to use from inside a
+// pool job. The first exception thrown by fn is rethrown once all workers
+// have stopped.
+void ParallelFor(size_t count, size_t concurrency,
+                 const std::function<void(size_t worker, size_t index)>& fn);
+
+#endif // WORKER_POOL_H
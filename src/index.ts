@@ -5,7 +5,7 @@ import * as path from 'path';
 const binding = require(path.join(__dirname, '../build/Release/poppler_binding.node'));
 
 // Export the native binding
-export const { Document, Page, version } = binding;
+export const { Document, Page, SearchIndex, processBatch, getStats, resetStats, observeStats, version } = binding;
 
 // Default export
 export default binding;
\ No newline at end of file
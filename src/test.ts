@@ -1,6 +1,9 @@
 // src/test.ts
-import { Document } from './index';
+import { Document, SearchIndex, getStats, processBatch } from './index';
 import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { Worker } from 'worker_threads';
 
 async function testPopplerBinding() {
   try {
@@ -34,22 +37,197 @@ async function testPopplerBinding() {
     const metadata = doc.getMetadata();
     console.log('✓ Document metadata:', metadata);
 
+    // A memory-mapped load must see the same document
+    const mapped = Document.loadFromFile(testPdfPath, { mmap: true });
+    if (mapped.getPageCount() !== pageCount) {
+      throw new Error('Memory-mapped document has a different page count');
+    }
+    console.log('✓ Document loaded through a memory mapping');
+
+    // Extract all pages in parallel
+    const texts = await doc.extractTextAsync();
+    if (texts.length !== pageCount) {
+      throw new Error(`Expected ${pageCount} texts, got ${texts.length}`);
+    }
+    console.log(`✓ Extracted text of ${texts.length} pages in parallel`);
+
+    // Stream every page and check it agrees with the parallel extraction
+    let streamed = 0;
+    for await (const item of doc.pages({ text: true, prefetch: 1 })) {
+      if (item.index !== streamed || item.text !== texts[streamed]) {
+        throw new Error(`Streamed page ${item.index} does not match extractTextAsync`);
+      }
+      streamed++;
+    }
+    if (streamed !== pageCount) {
+      throw new Error(`Expected ${pageCount} streamed pages, got ${streamed}`);
+    }
+    console.log(`✓ Streamed ${streamed} pages`);
+
+    // Several outputs per page, streamed as they finish
+    if (pageCount > 0) {
+      const outputs = [{ dpi: 18 }, { dpi: 36 }];
+      const rendered = new Set<string>();
+      for await (const item of doc.renderPages({ pages: `1-${pageCount}`, outputs, concurrency: 2 })) {
+        const expected = doc.getPage(item.index).renderToImage(outputs[item.output]);
+        if (item.image.width !== expected.width || item.image.height !== expected.height) {
+          throw new Error(`renderPages() output ${item.output} of page ${item.index} has the wrong size`);
+        }
+        rendered.add(`${item.index}:${item.output}`);
+      }
+      if (rendered.size !== pageCount * outputs.length) {
+        throw new Error(`Expected ${pageCount * outputs.length} rendered outputs, got ${rendered.size}`);
+      }
+      console.log(`✓ renderPages produced ${rendered.size} images`);
+    }
+
+    // Batch the same bytes three times plus one job that cannot load
+    const pdfBytes = fs.readFileSync(testPdfPath);
+    const batchJobs = [0, 1, 2].map(() => ({ buffer: pdfBytes, ops: { text: true } }));
+    const finished = new Set<number>();
+    for await (const result of processBatch([...batchJobs, { buffer: Buffer.from('not a pdf') }])) {
+      if (result.index === batchJobs.length) {
+        if (!result.error) {
+          throw new Error('Expected the invalid batch job to fail');
+        }
+      } else if (result.error || JSON.stringify(result.text) !== JSON.stringify(texts)) {
+        throw new Error(`Batch job ${result.index} does not match extractTextAsync`);
+      }
+      finished.add(result.index);
+    }
+    if (finished.size !== batchJobs.length + 1) {
+      throw new Error(`Expected ${batchJobs.length + 1} batch results, got ${finished.size}`);
+    }
+    console.log(`✓ Processed a batch of ${finished.size} documents`);
+
+    // Aborted calls and oversized requests fail without doing the work
+    const aborted = new AbortController();
+    aborted.abort();
+    const abortError = await doc.extractTextAsync({ signal: aborted.signal }).then(() => null, (e: Error) => e);
+    if (!abortError || !/aborted/.test(abortError.message)) {
+      throw new Error('Expected an aborted extractTextAsync to reject');
+    }
+    await doc.extractTextAsync({ timeoutMs: 0 }); // 0 means no limit
+    if (pageCount > 0) {
+      let limited = false;
+      try {
+        doc.getPage(0).renderToImage({ dpi: 72, maxPixels: 1 });
+      } catch {
+        limited = true;
+      }
+      if (!limited) {
+        throw new Error('Expected renderToImage to refuse a render over maxPixels');
+      }
+    }
+    console.log('✓ Abort signals and render limits are enforced');
+
+    // Everything above went through the instrumented paths
+    const stats = getStats();
+    if (stats.load.count === 0 || stats.documents.live === 0 || stats.textExtract.count === 0) {
+      throw new Error('Expected getStats() to have recorded the loads and extractions above');
+    }
+    console.log(`✓ Stats: ${stats.load.count} loads, p50 ${stats.load.p50.toFixed(2)} ms, ${stats.bytesCopied} bytes copied`);
+
+    // The document's bytes can be shared with a worker, which loads its own
+    // instance of the addon and borrows the same memory
+    const shared = doc.getSharedBuffer();
+    if (Document.loadFromBuffer(shared).getPageCount() !== pageCount || doc.getSharedBuffer() !== shared) {
+      throw new Error('Expected a document loaded from getSharedBuffer() to match');
+    }
+    const workerPageCount = await new Promise<number>((resolve, reject) => {
+      const worker = new Worker(
+        `const { parentPort, workerData } = require('worker_threads');
+         const { Document } = require(workerData.binding);
+         parentPort.postMessage(Document.loadFromBuffer(workerData.pdf).getPageCount());`,
+        {
+          eval: true,
+          workerData: { binding: path.resolve(__dirname, '../build/Release/poppler_binding.node'), pdf: shared },
+        }
+      );
+      worker.once('message', resolve);
+      worker.once('error', reject);
+    });
+    if (workerPageCount !== pageCount) {
+      throw new Error(`Worker saw ${workerPageCount} pages, expected ${pageCount}`);
+    }
+    console.log(`✓ Worker opened the shared ${shared.byteLength}-byte document`);
+
+    // Triage agrees with the loaded document
+    const probe = await Document.probe(fs.readFileSync(testPdfPath), { maxPages: 2 });
+    if (probe.pageCount !== pageCount || probe.locked !== doc.isLocked() ||
+        probe.pages.length !== Math.min(pageCount, 2) || !/^\d+\.\d+$/.test(probe.version)) {
+      throw new Error('Document.probe() does not match the loaded document');
+    }
+    console.log(`✓ Probe: PDF ${probe.version}, ${probe.imageCount} images, likely scanned: ${probe.likelyScanned}`);
+
     if (pageCount > 0) {
       // Get first page
       const page = doc.getPage(0);
       console.log('✓ First page obtained');
 
+      // A second lookup is served from the page cache
+      const before = doc.getPageCacheStats();
+      doc.getPage(0);
+      const after = doc.getPageCacheStats();
+      if (after.hits !== before.hits + 1) {
+        throw new Error('Expected getPage() to hit the page cache');
+      }
+      console.log(`✓ Page cache: ${after.hits} hits, ${after.misses} misses`);
+
       // Get page size
       const size = page.getSize();
       console.log(`✓ Page size: ${size.width}x${size.height}`);
 
+      // The packed geometries agree with the per-page getters
+      const geometries = doc.getPageGeometries();
+      const first = geometries.geometry.subarray(0, geometries.stride);
+      first[2] = -1; // callers get their own copy of the cached values
+      const again = doc.getPageGeometries();
+      if (geometries.pageCount !== pageCount || again.geometry[2] !== size.width || first[3] !== size.height ||
+          first[4] !== page.getRotation() || again.geometry === geometries.geometry) {
+        throw new Error('getPageGeometries() does not match getSize()/getRotation()');
+      }
+      console.log(`✓ Page geometries: ${geometries.geometry.length} values for ${geometries.pageCount} pages`);
+
+      // A page keeps working after its document is disposed, until it is
+      // disposed itself
+      const borrowed = Document.loadFromBuffer(fs.readFileSync(testPdfPath), { copy: false });
+      const pinnedPage = borrowed.getPage(0);
+      borrowed.dispose();
+      if (pinnedPage.getText() !== page.getText()) {
+        throw new Error('Expected a page to outlive its disposed document');
+      }
+      pinnedPage.dispose();
+      let disposedThrows = false;
+      try {
+        pinnedPage.getText();
+      } catch {
+        disposedThrows = true;
+      }
+      if (!disposedThrows) {
+        throw new Error('Expected a disposed page to throw');
+      }
+      console.log('✓ Pages pin their document; dispose() releases both');
+
       // Get page rotation
       const rotation = page.getRotation();
       console.log(`✓ Page rotation: ${rotation}°`);
 
       // Extract text
       const text = page.getText();
+      if (text !== texts[0]) {
+        throw new Error('Parallel text extraction does not match getText()');
+      }
       console.log(`✓ Text extracted (${text.length} characters)`);
+
+      // Reading order only rearranges the page's words
+      const readingWords = page.getText({ mode: 'reading' }).split(/\s+/).filter((word) => word.length > 0).sort();
+      const boxWords = page.getTextBoxes().map((box) => box.text).sort();
+      if (readingWords.join(' ') !== boxWords.join(' ')) {
+        throw new Error('Reading-order text does not contain the words of getTextBoxes()');
+      }
+      const raw = page.getText({ mode: 'raw' });
+      console.log(`✓ Text modes: ${readingWords.length} words in reading order, ${raw.length} raw characters`);
       console.log('First 200 characters:', text.substring(0, 200));
 
       // Get text boxes with coordinates
@@ -59,6 +237,17 @@ async function testPopplerBinding() {
         console.log('First text box:', textBoxes[0]);
       }
 
+      // Columnar text boxes must describe the same boxes
+      const columnar = page.getTextBoxesColumnar();
+      if (columnar.count !== textBoxes.length || columnar.offsets.length !== textBoxes.length + 1) {
+        throw new Error('Columnar text boxes do not match getTextBoxes()');
+      }
+      if (textBoxes.length > 0 &&
+          columnar.text.toString('utf8', columnar.offsets[0], columnar.offsets[1]) !== textBoxes[0].text) {
+        throw new Error('Columnar text does not match getTextBoxes()');
+      }
+      console.log(`✓ Columnar text boxes: ${columnar.count} boxes, ${columnar.text.length} bytes of text`);
+
       // Export page content to JSON
       const pageJSON = page.exportToJSON();
       console.log('✓ Page exported to JSON');
@@ -68,6 +257,52 @@ async function testPopplerBinding() {
         console.log(`First line has ${pageJSON.lines[0].words.length} words`);
       }
 
+      // Every word of the page can be found through the search index
+      const index = await doc.buildSearchIndex();
+      const firstWord = textBoxes.find((box) => /[a-z0-9]/i.test(box.text));
+      if (firstWord) {
+        const hits = index.search(firstWord.text);
+        if (!hits.some((hit) => hit.page === 0)) {
+          throw new Error(`Search for "${firstWord.text}" did not find page 0`);
+        }
+        const restored = SearchIndex.deserialize(index.serialize());
+        if (JSON.stringify(restored.search(firstWord.text)) !== JSON.stringify(hits)) {
+          throw new Error('Deserialized search index returns different hits');
+        }
+        // A header claiming more terms than the input holds is rejected, not allocated
+        const forged = index.serialize().subarray(0, 24);
+        forged.writeUInt32LE(0xffffffff, 16);
+        let forgedRejected = false;
+        try {
+          SearchIndex.deserialize(forged);
+        } catch {
+          forgedRejected = true;
+        }
+        if (!forgedRejected) {
+          throw new Error('Expected a forged search index header to be rejected');
+        }
+        console.log(`✓ Search index: "${firstWord.text}" found ${hits.length} times`);
+      }
+
+      // Blocks must cover every line exactly once
+      const withBlocks = page.exportToJSON({ blocks: true });
+      const blockLines = (withBlocks.blocks ?? []).flatMap((block) => block.lines).sort((a, b) => a - b);
+      if (blockLines.length !== withBlocks.lines.length || blockLines.some((line, i) => line !== i)) {
+        throw new Error('Blocks do not partition the page lines');
+      }
+      console.log(`✓ Grouped ${withBlocks.lines.length} lines into ${withBlocks.blocks?.length} blocks`);
+
+      // Native serialization matches the object form; NDJSON has a record per line
+      const nativeJSON = page.exportToJSON({ blocks: true, format: 'json' });
+      const ndjson = page.exportToJSON({ blocks: true, format: 'ndjson', output: 'buffer' }).toString('utf-8');
+      const textOnly = page.exportToJSON({ words: false, bboxes: false });
+      if (JSON.stringify(JSON.parse(nativeJSON)) !== JSON.stringify(withBlocks) ||
+          ndjson.trimEnd().split('\n').length !== withBlocks.lines.length + 2 ||
+          textOnly.lines.some((line, i) => 'words' in line || 'bbox' in line || line.text !== withBlocks.lines[i].text)) {
+        throw new Error('Serialized or field-selected export does not match exportToJSON()');
+      }
+      console.log(`✓ Native JSON export (${nativeJSON.length} characters)`);
+
       // Render page to image
       const image = page.renderToImage({
         dpi: 150,
@@ -78,6 +313,79 @@ async function testPopplerBinding() {
       // Save rendered image (example - you'd need additional image processing)
       console.log(`✓ Image data size: ${image.data.length} bytes`);
 
+      // Render the same page off the main thread
+      const asyncImage = await page.renderToImageAsync({ dpi: 150, rotation: 0 });
+      if (asyncImage.data.length !== image.data.length) {
+        throw new Error('Async render does not match sync render');
+      }
+      console.log(`✓ Page rendered asynchronously: ${asyncImage.width}x${asyncImage.height}`);
+
+      // Convert and encode natively
+      const rgb = page.renderToImage({ dpi: 150, encoding: 'rgb' });
+      if (rgb.format !== 'RGB' || rgb.data.length !== rgb.width * rgb.height * 3) {
+        throw new Error('Unexpected RGB output');
+      }
+      const png = await page.renderToImageAsync({ dpi: 150, encoding: 'png' });
+      if (png.data.readUInt32BE(0) !== 0x89504e47) {
+        throw new Error('PNG output is missing its signature');
+      }
+      console.log(`✓ Page encoded natively (RGB ${rgb.data.length} bytes, PNG ${png.data.length} bytes)`);
+
+      // Render into a reusable buffer
+      const target = Buffer.alloc(image.data.length);
+      const info = page.renderInto(target, { dpi: 150, rotation: 0 });
+      if (info.byteLength !== image.data.length || !target.equals(image.data)) {
+        throw new Error('renderInto does not match renderToImage');
+      }
+      console.log(`✓ Page rendered into caller buffer (${info.byteLength} bytes)`);
+
+      // Thumbnails fit the requested box
+      const thumbs = await doc.renderThumbnails(64);
+      if (thumbs.length !== pageCount || thumbs.some((t) => t.width > 64 || t.height > 64 || Math.max(t.width, t.height) < 63)) {
+        throw new Error('Thumbnails do not fit a 64px box');
+      }
+      const gray = page.renderToImage({ profile: 'preview', fit: { width: 100 }, encoding: 'gray' });
+      if (gray.format !== 'GRAY8' || gray.width > 100 || gray.data.length !== gray.width * gray.height) {
+        throw new Error('Unexpected preview output');
+      }
+      console.log(`✓ Rendered ${thumbs.length} thumbnails and a ${gray.width}x${gray.height} gray preview`);
+
+      // A tile is the matching rectangle of the full render
+      const region = { x: 10, y: 20, width: 64, height: 32 };
+      const tile = page.renderToImage({ dpi: 150, region });
+      if (tile.width !== region.width || tile.height !== region.height) {
+        throw new Error(`Expected ${region.width}x${region.height} tile, got ${tile.width}x${tile.height}`);
+      }
+      const row = region.width * 4;
+      for (let y = 0; y < region.height; y++) {
+        const offset = (region.y + y) * image.bytesPerRow + region.x * 4;
+        if (!tile.data.subarray(y * tile.bytesPerRow, y * tile.bytesPerRow + row)
+          .equals(image.data.subarray(offset, offset + row))) {
+          throw new Error(`Tile row ${y} does not match the full render`);
+        }
+      }
+      const edge = page.renderToImage({ dpi: 150, region: { x: image.width - 8, y: 0, width: 64, height: 8 } });
+      if (edge.width !== 8) {
+        throw new Error(`Expected a region past the page edge to be cut to 8 pixels, got ${edge.width}`);
+      }
+      let badRegion = false;
+      try {
+        page.renderToImage({ dpi: 150, region: { x: 0, y: 0, width: 0, height: 8 } });
+      } catch {
+        badRegion = true;
+      }
+      if (!badRegion) {
+        throw new Error('Expected an empty region to be rejected');
+      }
+
+      doc.setTileCacheSize(16 * 1024 * 1024);
+      const tiles = await doc.renderTilesAsync([{ page: 0, ...region }, { page: 0, ...region }], { dpi: 150 });
+      const repeat = await doc.renderTilesAsync([{ page: 0, ...region }], { dpi: 150 });
+      if (!tiles[0].data.equals(tile.data) || !repeat[0].data.equals(tile.data) || doc.getTileCacheStats().hits < 1) {
+        throw new Error('renderTilesAsync does not match renderToImage or missed the tile cache');
+      }
+      console.log(`✓ Rendered ${tiles.length + repeat.length} tiles (${doc.getTileCacheStats().hits} cache hits)`);
+
       // Export page to JSON and compare with test.json
       const docJSON = page.exportToJSON();
       fs.writeFileSync('./test_output.json', JSON.stringify(docJSON, null, 2));
@@ -99,6 +407,28 @@ async function testPopplerBinding() {
       } else {
         console.log('⚠️  test.json not found for comparison');
       }
+
+      // A second load of the same bytes is served from the extraction cache
+      const cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'poppler-ts-cache-'));
+      try {
+        doc.setExtractionCache(cacheDir);
+        const stored = doc.getPage(0).exportToJSON();
+        const reloaded = Document.loadFromBuffer(fs.readFileSync(testPdfPath));
+        if (reloaded.getContentHash() !== doc.getContentHash()) {
+          throw new Error('Identical bytes produced different content hashes');
+        }
+        reloaded.setExtractionCache(cacheDir);
+        const cachedPage = reloaded.getPage(0);
+        if (JSON.stringify(cachedPage.exportToJSON()) !== JSON.stringify(docJSON) ||
+            JSON.stringify(stored) !== JSON.stringify(docJSON) ||
+            cachedPage.getText() !== page.getText()) {
+          throw new Error('Extraction cache returned different results');
+        }
+        console.log(`✓ Extraction cache hit for ${doc.getContentHash()}`);
+      } finally {
+        doc.setExtractionCache(null);
+        fs.rmSync(cacheDir, { recursive: true, force: true });
+      }
     }    
 
     console.log('\n🎉 All tests completed successfully!');
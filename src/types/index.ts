@@ -7,9 +7,74 @@ export interface PageSize {
   y: number;
 }
 
+export type ImageEncoding = 'argb32' | 'rgba' | 'rgb' | 'gray' | 'png' | 'jpeg';
+
+export interface RenderRegion {
+  x: number;      // left edge in output pixels at the render resolution
+  y: number;      // top edge in output pixels
+  width: number;
+  height: number;
+}
+
+export type RenderProfile = 'thumbnail' | 'preview' | 'print';
+
 export interface RenderOptions {
+  profile?: RenderProfile; // preset dpi and hints (36/96/300 dpi); other options refine it
   dpi?: number;
+  scale?: number;          // dpi / 72; takes precedence over dpi
+  fit?: {                  // scale the page to fit this pixel box instead of using dpi
+    width?: number;
+    height?: number;
+  };
   rotation?: number;
+  encoding?: ImageEncoding; // 'rgb' and 'gray' are rendered natively by poppler
+  region?: RenderRegion;    // render only this part of the page (whole pixels, cut to the page edges)
+  antialiasing?: boolean;   // per-render overrides of the document's render hints
+  textAntialiasing?: boolean;
+  textHinting?: boolean;
+  maxPixels?: number;       // fail before rendering more pixels than this (default: no limit)
+}
+
+export interface CancelOptions {
+  signal?: AbortSignal; // abort the call; checked between pages, tiles and phases
+  timeoutMs?: number;   // fail once the call has run this long, checked at the same points (0: no limit)
+}
+
+export interface AsyncRenderOptions extends RenderOptions, CancelOptions {}
+
+export interface TextBoxOptions {
+  maxTextBoxes?: number; // fail instead of converting pages with more boxes (default: no limit)
+}
+
+export interface TextOptions extends TextBoxOptions {
+  // 'default': poppler's physical layout, columns and spacing kept as on
+  // the page; 'raw': content stream order; 'reading': lines grouped into
+  // blocks and read column by column
+  mode?: 'default' | 'raw' | 'reading';
+  lineTolerance?: number; // 'reading': max distance between word centres, in font heights (default: 0.5)
+  columnGap?: number;     // 'reading': split lines at gaps wider than this many font heights (default: 1)
+  blockGap?: number;      // 'reading': max gap between lines of one block, in font heights (default: 1)
+}
+
+export interface ThumbnailOptions extends Omit<RenderOptions, 'fit' | 'region'>, CancelOptions {
+  pages?: number[];     // 0-based page indices (default: all pages)
+  concurrency?: number; // worker threads to use (default: CPU core count)
+}
+
+export interface Tile extends RenderRegion {
+  page: number; // 0-based page index
+}
+
+export interface RenderTilesOptions extends Omit<RenderOptions, 'region'>, CancelOptions {
+  concurrency?: number; // worker threads to use (default: CPU core count)
+}
+
+export interface TileCacheStats {
+  hits: number;
+  misses: number;
+  size: number;     // tiles currently cached
+  bytes: number;    // memory held by the cached tiles (bitmaps plus encoded bytes)
+  capacity: number; // maximum bytes cached
 }
 
 export interface RenderedImage {
@@ -20,10 +85,182 @@ export interface RenderedImage {
   format: string;
 }
 
+export interface LoadOptions {
+  mmap?: boolean; // map the file instead of reading it (default: false)
+}
+
+export interface BufferLoadOptions {
+  copy?: boolean; // false: read straight from the Buffer, which must then stay unmodified (default: true)
+}
+
+export interface ExtractTextOptions extends CancelOptions {
+  pages?: number[];     // 0-based page indices (default: all pages)
+  concurrency?: number; // worker threads to use (default: CPU core count)
+}
+
+export interface PageStreamOptions extends CancelOptions {
+  pages?: number[];                  // 0-based page indices (default: all pages)
+  text?: boolean;                    // include the page text (default: false)
+  boxes?: boolean;                   // include the page's text boxes (default: false)
+  render?: boolean | RenderOptions;  // include a rendered image (default: false)
+  prefetch?: number;                 // pages prepared ahead of the consumer (default: 2)
+}
+
+export interface StreamedPage {
+  index: number;
+  text?: string;
+  boxes?: TextBox[];
+  image?: RenderedImage;
+}
+
+export interface RenderPagesOptions extends CancelOptions {
+  outputs: RenderOptions[];      // rendered for every page, in this order
+  pages?: string | number[];     // page numbers such as '1-50' or '1,3,7-', or 0-based indices (default: all pages)
+  concurrency?: number;          // worker threads to use (default: CPU core count)
+}
+
+export interface RenderedPageOutput {
+  index: number;        // 0-based page index
+  output: number;       // position in `outputs`
+  image: RenderedImage;
+}
+
+export interface BatchOps {
+  text?: boolean;                    // extract each page's text (default: false)
+  render?: boolean | RenderOptions;  // render each page (default: false)
+  pages?: number[];                  // 0-based page indices (default: all pages)
+  password?: string;
+}
+
+export interface BatchJob {
+  buffer: Buffer;
+  ops?: BatchOps;
+  timeoutMs?: number; // overrides the batch's timeoutMs for this job
+  maxBytes?: number;  // overrides the batch's maxBytes for this job
+}
+
+export interface BatchOptions {
+  concurrency?: number; // documents processed at once (default: CPU core count)
+  timeoutMs?: number;   // per-job time limit, checked between pages (default: none)
+  maxBytes?: number;    // per-job limit on input, text and image bytes held (default: none)
+  signal?: AbortSignal; // abort the whole batch; jobs stop between pages
+}
+
+export interface BatchResult {
+  index: number;            // position of the job in the jobs array
+  pageCount?: number;
+  pages?: number[];         // pages processed, in order
+  text?: string[];          // one entry per processed page
+  images?: RenderedImage[]; // one entry per processed page
+  error?: string;           // set instead of the other fields when the job failed
+}
+
+export interface StatsHistogram {
+  count: number;
+  sum: number;
+  min: number;
+  max: number;
+  mean: number;
+  p50: number; // percentiles are bucketed to within a factor of two
+  p90: number;
+  p99: number;
+}
+
+export interface Stats {
+  load: StatsHistogram;               // opening a document, ms
+  pageCreate: StatsHistogram;         // parsing a page, ms
+  textExtract: StatsHistogram;        // extracting one page's text or boxes, ms
+  renderPerMegapixel: StatsHistogram; // rendering, ms per megapixel
+  bytesCopied: number;                // bytes copied into JS strings and arrays
+  documents: { live: number; nativeBytes: number };
+  pages: { live: number };
+  externalBytes: number;              // native memory currently reported to V8
+}
+
+export interface StatsEntry {
+  name: 'load' | 'pageCreate' | 'textExtract' | 'render';
+  entryType: 'poppler';
+  startTime: number; // on the performance.now() timeline
+  duration: number;  // ms
+  detail?: { pixels: number };
+}
+
+export interface SearchIndexOptions extends CancelOptions {
+  concurrency?: number; // worker threads to use (default: CPU core count)
+}
+
+export interface SearchOptions {
+  limit?: number; // maximum hits returned (default: all)
+}
+
+export interface SearchHit {
+  page: number; // 0-based page index
+  bbox: {
+    x: number;
+    y: number;
+    width: number;
+    height: number;
+  };
+}
+
+export interface RenderIntoResult {
+  width: number;
+  height: number;
+  bytesPerRow: number;
+  format: string;
+  byteLength: number; // bytes written at the start of the target
+}
+
+export type RenderTarget = Buffer | ArrayBufferView | ArrayBuffer;
+
+export interface PageCacheStats {
+  hits: number;
+  misses: number;
+  size: number;     // pages currently cached
+  capacity: number; // maximum pages cached
+}
+
+export interface RenderHints {
+  antialiasing?: boolean;
+  textAntialiasing?: boolean;
+  textHinting?: boolean;
+}
+
 export interface DocumentMetadata {
   [key: string]: string;
 }
 
+export interface PageGeometries {
+  pageCount: number;
+  stride: number;          // values per page: 6
+  geometry: Float64Array;  // x, y, width, height, rotation, duration per page (NaN if a page fails to load)
+  metadata: DocumentMetadata;
+}
+
+export interface ProbeOptions extends CancelOptions {
+  password?: string;
+  maxPages?: number;    // pages whose text is sampled, spread evenly (default: 8, 0 for all)
+  concurrency?: number; // worker threads to use (default: CPU core count)
+}
+
+export interface PageProbe {
+  index: number;
+  hasText: boolean;
+  characters: number; // non-whitespace characters of text
+  ms: number;         // time to parse the page and extract its text
+}
+
+export interface ProbeResult {
+  pageCount: number;
+  locked: boolean;     // a password is needed; nothing past this is read
+  encrypted: boolean;
+  version: string;     // PDF version, e.g. "1.7"
+  imageCount: number;  // heuristic: image XObjects in the raw bytes; misses object streams, counts shared images once
+  metadata: DocumentMetadata;
+  pages: PageProbe[];  // the sampled pages, in order
+  likelyScanned: boolean; // images but no text on any sampled page
+}
+
 export interface TextBox {
   text: string;
   bbox: {
@@ -34,6 +271,17 @@ export interface TextBox {
   };
 }
 
+export interface ColumnarTextBoxOptions extends TextBoxOptions {
+  precision?: 'float32' | 'float64'; // bbox element type (default: 'float64')
+}
+
+export interface ColumnarTextBoxes {
+  count: number;
+  bboxes: Float64Array | Float32Array; // x, y, width, height per box
+  text: Buffer;                        // UTF-8 text of all boxes, back to back
+  offsets: Uint32Array;                // box i is text[offsets[i] .. offsets[i + 1])
+}
+
 export interface Word {
   text: string;
   bbox: {
@@ -55,6 +303,16 @@ export interface Line {
   words: Word[];
 }
 
+export interface Block {
+  bbox: {
+    x: number;
+    y: number;
+    width: number;
+    height: number;
+  };
+  lines: number[]; // indices into PageJSON.lines
+}
+
 export interface PageJSON {
   page: {
     width: number;
@@ -62,18 +320,44 @@ export interface PageJSON {
     rotation: number;
   };
   lines: Line[];
+  blocks?: Block[]; // present when requested with { blocks: true }
+}
+
+export interface LayoutOptions extends TextBoxOptions {
+  lineTolerance?: number; // max distance between word centres, in font heights (default: 0.5)
+  columnGap?: number;     // split lines at gaps wider than this many font heights (default: 0, off)
+  blockGap?: number;      // max gap between lines of one block, in font heights (default: 1)
+  blocks?: boolean;       // also group lines into blocks (default: false)
+  lines?: boolean;        // emit lines with their text (default: true)
+  words?: boolean;        // emit each line's words (default: true)
+  bboxes?: boolean;       // emit bboxes on lines, words and blocks (default: true)
+}
+
+export interface SerializedLayoutOptions extends LayoutOptions {
+  format: 'json' | 'ndjson'; // serialize natively instead of building objects
+  output?: 'string' | 'buffer'; // (default: 'string')
 }
 
 export declare class Document {
   /**
    * Load a PDF document from file path
    */
-  static loadFromFile(filepath: string, password?: string): Document;
+  static loadFromFile(filepath: string, password?: string, options?: LoadOptions): Document;
+  static loadFromFile(filepath: string, options: LoadOptions): Document;
+  
+  /**
+   * Load a PDF document from buffer. A SharedArrayBuffer (or a view of one)
+   * is borrowed instead of copied, so workers can open the same bytes.
+   */
+  static loadFromBuffer(buffer: Buffer | Uint8Array | SharedArrayBuffer, password?: string, options?: BufferLoadOptions): Document;
+  static loadFromBuffer(buffer: Buffer | Uint8Array | SharedArrayBuffer, options: BufferLoadOptions): Document;
   
   /**
-   * Load a PDF document from buffer
+   * Triage a PDF without loading it for use: version, encryption, page
+   * count, metadata, an image count and a text sample of a few pages.
+   * The buffer is borrowed until the promise settles.
    */
-  static loadFromBuffer(buffer: Buffer, password?: string): Document;
+  static probe(buffer: Buffer | Uint8Array | SharedArrayBuffer, options?: ProbeOptions): Promise<ProbeResult>;
   
   /**
    * Get the number of pages in the document
@@ -90,6 +374,12 @@ export declare class Document {
    */
   getMetadata(): DocumentMetadata;
   
+  /**
+   * Size, rotation and duration of every page in one packed array, plus the
+   * metadata. Computed once; later calls return the same object.
+   */
+  getPageGeometries(): PageGeometries;
+  
   /**
    * Check if the document is locked/encrypted
    */
@@ -99,6 +389,76 @@ export declare class Document {
    * Unlock the document with a password
    */
   unlock(password: string): boolean;
+  
+  /**
+   * Extract the text of many pages in parallel on native worker threads.
+   * Results are returned in the order the pages were requested.
+   */
+  extractTextAsync(options?: ExtractTextOptions): Promise<string[]>;
+  
+  /**
+   * Iterate over pages with `for await`. A native producer thread prepares
+   * pages ahead of the consumer and pauses once `prefetch` pages are waiting.
+   * Breaking out of the loop stops the producer.
+   */
+  pages(options?: PageStreamOptions): AsyncIterableIterator<StreamedPage>;
+  
+  /**
+   * Render several outputs (e.g. thumbnail, preview and full size) of each
+   * page on native worker threads. Each page is parsed once by the worker
+   * that claims it, and every image is yielded as soon as it is ready.
+   */
+  renderPages(options: RenderPagesOptions): AsyncIterableIterator<RenderedPageOutput>;
+  
+  /**
+   * Render many page regions in parallel on native worker threads.
+   * Results are returned in the order the tiles were requested.
+   */
+  renderTilesAsync(tiles: Tile[], options?: RenderTilesOptions): Promise<RenderedImage[]>;
+  
+  /**
+   * Render every page (or options.pages) to fit a size x size box with the
+   * 'thumbnail' profile, in parallel on native worker threads
+   */
+  renderThumbnails(size: number, options?: ThumbnailOptions): Promise<RenderedImage[]>;
+  
+  /**
+   * Set the byte budget of the tile cache used by renderTilesAsync() (default: 0, disabled)
+   */
+  setTileCacheSize(bytes: number): void;
+  
+  /**
+   * Get tile cache hit/miss counters
+   */
+  getTileCacheStats(): TileCacheStats;
+  
+  /**
+   * Set how many parsed pages getPage() keeps cached (default: 32, 0 disables)
+   */
+  setPageCacheSize(size: number): void;
+  
+  /**
+   * Get page cache hit/miss counters
+   */
+  getPageCacheStats(): PageCacheStats;
+  
+  /**
+   * Configure the renderer shared by all renders of this document
+   */
+  setRenderHints(hints: RenderHints): void;
+  
+  /**
+   * The document's bytes in a SharedArrayBuffer, copied on the first call.
+   * Post it to worker_threads and open it there with loadFromBuffer().
+   */
+  getSharedBuffer(): SharedArrayBuffer;
+  
+  /**
+   * Release the document's native memory now instead of at garbage
+   * collection. Pages already obtained stay usable until they are disposed.
+   */
+  dispose(): void;
+  [Symbol.dispose](): void;
 }
 
 export declare class Page {
@@ -108,15 +468,33 @@ export declare class Page {
   getSize(): PageSize;
   
   /**
-   * Extract all text from the page
+   * Extract all text from the page, optionally in another layout mode
    */
-  getText(): string;
+  getText(options?: TextOptions): string;
   
   /**
    * Render the page to an image
    */
   renderToImage(options?: RenderOptions): RenderedImage;
   
+  /**
+   * Render the page to an image on a native worker thread.
+   * The page and its document stay alive until the promise settles.
+   */
+  renderToImageAsync(options?: AsyncRenderOptions): Promise<RenderedImage>;
+  
+  /**
+   * Render the page into caller-owned memory so it can be reused across renders.
+   * Throws a RangeError if the target is smaller than the rendered bitmap.
+   */
+  renderInto(target: RenderTarget, options?: RenderOptions): RenderIntoResult;
+  
+  /**
+   * Like renderInto(), but renders on a native worker thread.
+   * The target must not be read or written until the promise settles.
+   */
+  renderIntoAsync(target: RenderTarget, options?: AsyncRenderOptions): Promise<RenderIntoResult>;
+  
   /**
    * Get page rotation in degrees
    */
@@ -130,12 +508,76 @@ export declare class Page {
   /**
    * Get text boxes with coordinates
    */
-  getTextBoxes(): TextBox[];
+  getTextBoxes(options?: TextBoxOptions): TextBox[];
+  
+  /**
+   * Get text boxes as packed typed arrays instead of one object per box
+   */
+  getTextBoxesColumnar(options?: ColumnarTextBoxOptions): ColumnarTextBoxes;
+  
+  /**
+   * Export page content to JSON with detailed positioning.
+   * Fields turned off with lines/words/bboxes are absent from the result.
+   */
+  exportToJSON(options?: LayoutOptions & { format?: 'object' }): PageJSON;
   
   /**
-   * Export page content to JSON with detailed positioning
+   * Serialize the same structure natively as JSON, or as NDJSON with one
+   * record per line ({ page } first, then each line, then { blocks })
    */
-  exportToJSON(): PageJSON;
+  exportToJSON(options: SerializedLayoutOptions & { output: 'buffer' }): Buffer;
+  exportToJSON(options: SerializedLayoutOptions): string;
+  
+  /**
+   * Release the page's native memory now; the page cannot be used afterwards
+   */
+  dispose(): void;
+  [Symbol.dispose](): void;
 }
 
+export declare class SearchIndex {
+  /**
+   * Restore an index produced by serialize()
+   */
+  static deserialize(buffer: Buffer): SearchIndex;
+  
+  /**
+   * Find the query's words in sequence (case-insensitive, punctuation ignored)
+   */
+  search(query: string, options?: SearchOptions): SearchHit[];
+  
+  /**
+   * Compact binary form that can be persisted and restored with deserialize()
+   */
+  serialize(): Buffer;
+  
+  /**
+   * Number of pages indexed
+   */
+  getPageCount(): number;
+}
+
+/**
+ * Load, extract and render many documents on the native worker pool.
+ * Results are yielded as jobs finish, not in input order; a failed job
+ * yields a result with `error` and the batch carries on.
+ */
+export declare function processBatch(jobs: BatchJob[], options?: BatchOptions): AsyncIterableIterator<BatchResult>;
+
+/**
+ * Process-wide counters and latency histograms since load or resetStats()
+ */
+export declare function getStats(): Stats;
+
+/**
+ * Clear the histograms and bytesCopied; live counts are unaffected
+ */
+export declare function resetStats(): void;
+
+/**
+ * Receive a perf_hooks-style entry for every timed operation, or pass null
+ * to stop. Entries are delivered asynchronously on the main thread.
+ */
+export declare function observeStats(callback: ((entry: StatsEntry) => void) | null): void;
+
 export declare const version: string;
\ No newline at end of file